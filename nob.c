@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <ctype.h>
 #define NOB_IMPLEMENTATION
 #include "nob.h" // Code from: https://github.com/tsoding/nob.h
 
@@ -13,6 +14,9 @@
 
 #include "src/build_defines.h"
 #include "nob_src/raylib_extracts.h"
+#include "src/atlas_format.h" // After raylib_extracts.h, it needs ComputeCRC32.
+#include "src/texture_format.h"
+#include "src/pack_format.h"
 
 #ifdef _WIN32
 #define MAX_PATH_LENGTH MAX_PATH
@@ -22,8 +26,34 @@
 
 #define SRC_FOLDER "src/"
 #define RESOURCE_FOLDER "resources/"
+#define GENERATED_FOLDER SRC_FOLDER "generated/"
 #define BUILD_FOLDER "bin/"
 #define OUT_PATH BUILD_FOLDER "my-raylib-game" // TEMPLATE: Rename to project name
+#define SPRITE_PACK_MAX_JOBS 8 // Atlases packed at once.
+
+// ::ATLAS MANIFEST
+// src/build_defines.h's ATLAS_MANIFEST with every name the packer needs spelled out.
+typedef struct AtlasManifestEntry {
+  const char* id;
+  const char* source_folder;
+  const char* image_file;
+  const char* texture_file;
+  const char* meta_file;
+  const char* meta_text_file;
+  const char* sprites_header;
+  const char* sprites_macro;
+  const char* sprite_id_prefix;
+  int         size;
+  int         max_sprites;
+} AtlasManifestEntry;
+
+static const AtlasManifestEntry ATLAS_MANIFEST_ENTRIES[] = {
+#define X(ID, sourceFolder, fileName, size, maxSprites) \
+  {#ID, sourceFolder, ATLAS_IMAGE_FILE(fileName), ATLAS_TEXTURE_FILE(fileName), ATLAS_META_FILE(fileName), ATLAS_META_TEXT_FILE(fileName), ATLAS_SPRITES_HEADER(fileName), #ID "_ATLAS_SPRITES", "SPRITE_" #ID "_", size, maxSprites},
+    ATLAS_MANIFEST(X)
+#undef X
+};
+#define ATLAS_MANIFEST_COUNT (int)(sizeof(ATLAS_MANIFEST_ENTRIES) / sizeof(ATLAS_MANIFEST_ENTRIES[0]))
 
 // ::HASH FUNCTIONS
 static unsigned int hash_string(const char* str) {
@@ -146,11 +176,35 @@ void FreeImageBuffer(ImageBuffer* img) {
   }
 }
 
-bool check_should_build_atlas_and_compute_hashes(const char* atlas_img_filename, const char* metadata_filename, const char* atlas_src_folder) {
+static bool is_atlas_metadata_current(const char* metadata_path) {
+  AtlasMetaHeader header = {0};
+  FILE*           file = fopen(metadata_path, "rb");
+  if (!file) return false;
+  bool read = fread(&header, sizeof(header), 1, file) == 1;
+  fclose(file);
+  return read && header.magic == ATLAS_META_MAGIC && header.version == ATLAS_META_VERSION;
+}
+
+static bool is_raw_texture_current(const char* texture_path) {
+  RawTextureHeader header = {0};
+  FILE*            file = fopen(texture_path, "rb");
+  if (!file) return false;
+  bool read = fread(&header, sizeof(header), 1, file) == 1;
+  fclose(file);
+  return read && header.magic == RAW_TEXTURE_MAGIC && header.version == RAW_TEXTURE_VERSION;
+}
+
+bool check_should_build_atlas_and_compute_hashes(const char* atlas_img_filename, const char* atlas_texture_filename, const char* metadata_filename, const char* metadata_text_filename, const char* sprites_header_filename, const char* atlas_src_folder) {
   char imageFilePath[MAX_PATH_LENGTH];
   snprintf(imageFilePath, sizeof(imageFilePath), "%s%s", RESOURCE_FOLDER, atlas_img_filename);
+  char textureFilePath[MAX_PATH_LENGTH];
+  snprintf(textureFilePath, sizeof(textureFilePath), "%s%s", RESOURCE_FOLDER, atlas_texture_filename);
   char metadataFilePath[MAX_PATH_LENGTH];
   snprintf(metadataFilePath, sizeof(metadataFilePath), "%s%s", RESOURCE_FOLDER, metadata_filename);
+  char metadataTextFilePath[MAX_PATH_LENGTH];
+  snprintf(metadataTextFilePath, sizeof(metadataTextFilePath), "%s%s", RESOURCE_FOLDER, metadata_text_filename);
+  char spritesHeaderPath[MAX_PATH_LENGTH];
+  snprintf(spritesHeaderPath, sizeof(spritesHeaderPath), "%s%s", GENERATED_FOLDER, sprites_header_filename);
   char hashfileFilename[MAX_PATH_LENGTH];
   snprintf(hashfileFilename, MAX_PATH_LENGTH, "%s.hash", GetFileNameWithoutExt(atlas_img_filename));
   char hashFilePath[MAX_PATH_LENGTH];
@@ -162,10 +216,16 @@ bool check_should_build_atlas_and_compute_hashes(const char* atlas_img_filename,
   uint32_t computedHash = 0;
 
   if (nob_file_exists(imageFilePath) < 1 ||
+      nob_file_exists(textureFilePath) < 1 ||
       nob_file_exists(metadataFilePath) < 1 ||
+      nob_file_exists(metadataTextFilePath) < 1 ||
+      nob_file_exists(spritesHeaderPath) < 1 ||
       nob_file_exists(hashFilePath) < 1) {
     nob_log(NOB_INFO, "Image/Metadata/Hash file not found. Triggering building of texture atlas for resources in folder: %s", atlas_src_folder);
     shouldRebuildAndComputeHash = true;
+  } else if (!is_atlas_metadata_current(metadataFilePath) || !is_raw_texture_current(textureFilePath)) {
+    nob_log(NOB_INFO, "Metadata format changed. Triggering building of texture atlas for resources in folder: %s", atlas_src_folder);
+    shouldRebuildAndComputeHash = true;
   } else {
     FILE* file = fopen(hashFilePath, "r");
     if (!file) {
@@ -200,6 +260,10 @@ bool check_should_build_atlas_and_compute_hashes(const char* atlas_img_filename,
   return shouldRebuildAndComputeHash;
 }
 
+static int compare_sprite_filenames(const void* a, const void* b) {
+  return strcmp(((const NOB_SpriteMetadata*)a)->filename, ((const NOB_SpriteMetadata*)b)->filename);
+}
+
 int load_sprites_from_directory(const char* directory_path, NOB_SpriteMetadata* sprites, const unsigned int MAX_SPRITES) {
   int file_count = 0;
 
@@ -235,11 +299,12 @@ int load_sprites_from_directory(const char* directory_path, NOB_SpriteMetadata*
     }
   }
 
+  qsort(sprites, file_count, sizeof(NOB_SpriteMetadata), compare_sprite_filenames); // Directory order differs between systems.
   nob_log(NOB_INFO, "%d sprites loaded from directory: %s", file_count, directory_path);
   return file_count;
 }
 
-void save_atlas_metadata(const char* filename, NOB_SpriteMetadata* sprites, int count) {
+void save_atlas_metadata_text(const char* filename, NOB_SpriteMetadata* sprites, int count) {
   char path[MAX_PATH_LENGTH];
   snprintf(path, sizeof(path), "%s%s", RESOURCE_FOLDER, filename);
 
@@ -263,8 +328,293 @@ void save_atlas_metadata(const char* filename, NOB_SpriteMetadata* sprites, int
   nob_log(NOB_INFO, "Successfully saved atlas meta file: %s", path);
 }
 
-void build_texture_atlas(const char* atlas_img_filename, const char* atlas_metadata_filename, const char* atlas_src_folder, int atlas_width, int atlas_height, const int MAX_SPRITES) {
-  bool shouldBuild = check_should_build_atlas_and_compute_hashes(atlas_img_filename, atlas_metadata_filename, atlas_src_folder);
+#define ATLAS_META_MAX_DISPLACEMENT (1u << 24)
+
+typedef struct {
+  uint32_t bucket;
+  uint32_t count;
+  uint32_t first; // Into the sprites grouped by bucket.
+} AtlasMetaBucket;
+
+static int compare_buckets_largest_first(const void* a, const void* b) {
+  const AtlasMetaBucket* bucketA = (const AtlasMetaBucket*)a;
+  const AtlasMetaBucket* bucketB = (const AtlasMetaBucket*)b;
+  if (bucketA->count != bucketB->count) return bucketA->count > bucketB->count ? -1 : 1;
+  return bucketA->bucket < bucketB->bucket ? -1 : bucketA->bucket > bucketB->bucket;
+}
+
+// Hash and displace: sprites go into buckets by name hash, then each bucket, largest first, gets
+// the first displacement that puts all of its sprites in free slots. Fills displacements and
+// slots. Fails only if two names share a CRC32.
+bool build_atlas_perfect_hash(const uint32_t* hashes, int count, uint32_t* displacements, uint32_t bucketCount, uint32_t* slots) {
+  AtlasMetaBucket* buckets = (AtlasMetaBucket*)calloc(bucketCount, sizeof(AtlasMetaBucket));
+  bool*            taken = (bool*)calloc(count, sizeof(bool));
+  uint32_t*        grouped = (uint32_t*)calloc(count, sizeof(uint32_t));
+  uint32_t*        memberSlots = (uint32_t*)calloc(count, sizeof(uint32_t));
+  bool             built = true;
+
+  for (uint32_t b = 0; b < bucketCount; b++) buckets[b].bucket = b;
+  for (int i = 0; i < count; i++) buckets[hashes[i] % bucketCount].count++;
+  for (uint32_t b = 0, first = 0; b < bucketCount; first += buckets[b++].count) buckets[b].first = first;
+  for (int i = 0; i < count; i++) {
+    AtlasMetaBucket* bucket = &buckets[hashes[i] % bucketCount];
+    grouped[bucket->first++] = (uint32_t)i;
+  }
+  for (uint32_t b = 0; b < bucketCount; b++) buckets[b].first -= buckets[b].count;
+  qsort(buckets, bucketCount, sizeof(AtlasMetaBucket), compare_buckets_largest_first);
+
+  for (uint32_t b = 0; b < bucketCount && buckets[b].count > 0; b++) {
+    const uint32_t* members = &grouped[buckets[b].first];
+    uint32_t        memberCount = buckets[b].count;
+
+    uint32_t displacement = 0;
+    for (; displacement < ATLAS_META_MAX_DISPLACEMENT; displacement++) {
+      bool fits = true;
+      for (uint32_t m = 0; m < memberCount && fits; m++) {
+        memberSlots[m] = GetAtlasMetaSlot(hashes[members[m]], displacement, (uint32_t)count);
+        fits = !taken[memberSlots[m]];
+        for (uint32_t other = 0; other < m && fits; other++) fits = memberSlots[other] != memberSlots[m];
+      }
+      if (fits) break;
+    }
+    if (displacement == ATLAS_META_MAX_DISPLACEMENT) {
+      built = false;
+      break;
+    }
+
+    displacements[buckets[b].bucket] = displacement;
+    for (uint32_t m = 0; m < memberCount; m++) {
+      taken[memberSlots[m]] = true;
+      slots[members[m]] = memberSlots[m];
+    }
+  }
+
+  free(memberSlots);
+  free(grouped);
+  free(taken);
+  free(buckets);
+  return built;
+}
+
+// Header, displacements, rect table in slot order, string pool. See src/atlas_format.h.
+void save_atlas_metadata(const char* filename, NOB_SpriteMetadata* sprites, int count) {
+  char path[MAX_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s%s", RESOURCE_FOLDER, filename);
+
+  uint32_t           bucketCount = (uint32_t)(count + ATLAS_META_SPRITES_PER_BUCKET - 1) / ATLAS_META_SPRITES_PER_BUCKET;
+  uint32_t*          displacements = (uint32_t*)calloc(bucketCount ? bucketCount : 1, sizeof(uint32_t));
+  uint32_t*          hashes = (uint32_t*)calloc(count, sizeof(uint32_t));
+  uint32_t*          slots = (uint32_t*)calloc(count, sizeof(uint32_t));
+  AtlasMetaRect*     rects = (AtlasMetaRect*)calloc(count, sizeof(AtlasMetaRect));
+  Nob_String_Builder names = {0};
+  for (int i = 0; i < count; i++) {
+    const char* name = GetFileNameWithoutExt(sprites[i].filename); // Stripped filename
+    size_t      length = strlen(name);
+    hashes[i] = ComputeCRC32((unsigned char*)name, (int)length);
+    for (int j = 0; j < i; j++) {
+      if (hashes[j] != hashes[i]) continue;
+      nob_log(NOB_ERROR, "Sprites %s and %s have the same name hash, rename one of them", GetFileName(sprites[j].filename), GetFileName(sprites[i].filename));
+      exit(1);
+    }
+  }
+  if (!build_atlas_perfect_hash(hashes, count, displacements, bucketCount, slots)) {
+    nob_log(NOB_ERROR, "Failed to build the sprite name hash for %s", path);
+    exit(1);
+  }
+
+  for (int i = 0; i < count; i++) {
+    const char* name = GetFileNameWithoutExt(sprites[i].filename);
+    size_t      length = strlen(name);
+    rects[slots[i]] = (AtlasMetaRect){
+        .x = (float)sprites[i].rect.x,
+        .y = (float)sprites[i].rect.y,
+        .width = (float)sprites[i].rect.width,
+        .height = (float)sprites[i].rect.height,
+        .nameOffset = (uint32_t)names.count,
+        .nameLength = (uint32_t)length,
+        .nameHash = hashes[i],
+    };
+    nob_sb_append_buf(&names, name, length + 1);
+  }
+  if (names.count == 0) nob_sb_append_null(&names); // Pool is never empty.
+
+  uint32_t        rectOffset = (uint32_t)(sizeof(AtlasMetaHeader) + sizeof(uint32_t) * bucketCount);
+  AtlasMetaHeader header = {
+      .magic = ATLAS_META_MAGIC,
+      .version = ATLAS_META_VERSION,
+      .spriteCount = (uint32_t)count,
+      .bucketCount = bucketCount,
+      .bucketOffset = sizeof(AtlasMetaHeader),
+      .rectStride = sizeof(AtlasMetaRect),
+      .rectOffset = rectOffset,
+      .stringOffset = (uint32_t)(rectOffset + sizeof(AtlasMetaRect) * count),
+      .stringSize = (uint32_t)names.count,
+  };
+
+  FILE* file = fopen(path, "wb");
+  bool  written = file &&
+                 fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 fwrite(displacements, sizeof(uint32_t), bucketCount, file) == bucketCount &&
+                 fwrite(rects, sizeof(AtlasMetaRect), count, file) == (size_t)count &&
+                 fwrite(names.items, 1, names.count, file) == names.count;
+  if (file) fclose(file);
+  free(rects);
+  free(slots);
+  free(hashes);
+  free(displacements);
+  nob_sb_free(names);
+
+  if (!written) {
+    nob_log(NOB_ERROR, "Failed to write metadata file: %s", path);
+    remove(path); // The folder hash is already saved, the next run only rebuilds if this is missing.
+    exit(1);
+  }
+  nob_log(NOB_INFO, "Successfully saved atlas meta file: %s", path);
+}
+
+// X macro with every sprite in the atlas, for the SpriteID enum and the rect table in the game:
+//   #define MAIN_ATLAS_SPRITES(X) X(SPRITE_MAIN_PLAYER_1, "player_1", 0, 0, 128, 128) ...
+void save_atlas_sprites_header(const char* filename, const char* sprites_macro, const char* sprite_id_prefix, const char* atlas_src_folder, NOB_SpriteMetadata* sprites, int count) {
+  char path[MAX_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s%s", GENERATED_FOLDER, filename);
+  if (!nob_mkdir_if_not_exists(GENERATED_FOLDER)) exit(1);
+
+  char**             names = (char**)calloc(count, sizeof(char*));
+  Nob_String_Builder header = {0};
+  nob_sb_append_cstr(&header, "// Generated by nob's sprite packer from " RESOURCE_FOLDER);
+  nob_sb_append_cstr(&header, atlas_src_folder);
+  nob_sb_append_cstr(&header, ", don't edit.\n");
+  nob_sb_append_cstr(&header, "// X(id, name, x, y, width, height) for each sprite in the atlas.\n");
+  nob_sb_append_cstr(&header, nob_temp_sprintf("#ifndef %s_H\n#define %s_H\n\n#define %s(X)", sprites_macro, sprites_macro, sprites_macro));
+  bool valid = true;
+  for (int i = 0; i < count; i++) {
+    char* name = strdup(GetFileNameWithoutExt(sprites[i].filename));
+    names[i] = name;
+    for (int j = 0; j < i; j++) {
+      if (strcmp(names[j], name) != 0) continue;
+      nob_log(NOB_ERROR, "Two sprites are named %s in %s, sprite ids would clash", name, atlas_src_folder);
+      valid = false;
+    }
+
+    char id[MAX_PATH_LENGTH];
+    snprintf(id, sizeof(id), "%s%s", sprite_id_prefix, name);
+    for (char* c = id; *c; c++) *c = isalnum((unsigned char)*c) ? (char)toupper((unsigned char)*c) : '_';
+    Rect rect = sprites[i].rect;
+    nob_sb_append_cstr(&header, nob_temp_sprintf(" \\\n  X(%s, \"%s\", %d, %d, %d, %d)", id, name, rect.x, rect.y, rect.width, rect.height));
+  }
+  nob_sb_append_cstr(&header, nob_temp_sprintf("\n\n#endif // !%s_H\n", sprites_macro));
+  nob_temp_reset();
+
+  for (int i = 0; i < count; i++) free(names[i]);
+  free(names);
+  if (!valid) exit(1);
+  if (!nob_write_entire_file(path, header.items, header.count)) exit(1);
+  nob_sb_free(header);
+  nob_log(NOB_INFO, "Successfully saved atlas sprite header: %s", path);
+}
+
+// Appends an LZ4 length continuation: 255s, then the remainder.
+static void lz4_write_length(uint8_t** out, size_t length) {
+  for (; length >= 255; length -= 255) *(*out)++ = 255;
+  *(*out)++ = (uint8_t)length;
+}
+
+static void lz4_write_sequence(uint8_t** out, const uint8_t* literals, size_t literal_count, size_t offset, size_t match_length) {
+  uint8_t* token = (*out)++;
+  *token = (uint8_t)((literal_count < 15 ? literal_count : 15) << 4);
+  if (literal_count >= 15) lz4_write_length(out, literal_count - 15);
+  memcpy(*out, literals, literal_count);
+  *out += literal_count;
+  if (match_length == 0) return; // Last sequence.
+  *(*out)++ = (uint8_t)(offset & 0xFF);
+  *(*out)++ = (uint8_t)(offset >> 8);
+  size_t length = match_length - RAW_TEXTURE_LZ4_MIN_MATCH;
+  *token |= (uint8_t)(length < 15 ? length : 15);
+  if (length >= 15) lz4_write_length(out, length - 15);
+}
+
+// Greedy LZ4 block compressor, decoded by DecompressRawTexture in src/texture_format.h. Keeps LZ4's
+// end of block rules (last 5 bytes are literals, no match starts in the last 12) so other LZ4
+// decoders read it too. out needs lz4_compress_bound(size) bytes. Returns the compressed size.
+#define LZ4_HASH_BITS 16
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_FIND_LIMIT 12
+
+static size_t lz4_compress_bound(size_t size) { return size + size / 255 + 16; }
+
+static size_t lz4_compress(const uint8_t* in, size_t size, uint8_t* out) {
+  uint32_t* table = (uint32_t*)calloc(1 << LZ4_HASH_BITS, sizeof(uint32_t)); // Last position of each 4 byte hash.
+  uint8_t*  op = out;
+  size_t    anchor = 0;
+  size_t    pos = 0;
+  size_t    limit = size > LZ4_MATCH_FIND_LIMIT ? size - LZ4_MATCH_FIND_LIMIT : 0;
+  while (pos < limit) {
+    uint32_t sequence;
+    memcpy(&sequence, in + pos, sizeof(sequence));
+    uint32_t hash = (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+    size_t   candidate = table[hash];
+    table[hash] = (uint32_t)pos;
+    if (candidate >= pos || pos - candidate > LZ4_MAX_OFFSET || memcmp(in + candidate, in + pos, sizeof(sequence)) != 0) {
+      pos++;
+      continue;
+    }
+    size_t end = pos + RAW_TEXTURE_LZ4_MIN_MATCH;
+    size_t match_limit = size - LZ4_LAST_LITERALS;
+    while (end < match_limit && in[end] == in[candidate + end - pos]) end++;
+    lz4_write_sequence(&op, in + anchor, pos - anchor, pos - candidate, end - pos);
+    pos = end;
+    anchor = pos;
+  }
+  lz4_write_sequence(&op, in + anchor, size - anchor, 0, 0);
+  free(table);
+  return (size_t)(op - out);
+}
+
+// Pre-decoded copy of an RGBA image for the game to upload without a PNG decode, see
+// src/texture_format.h. Stored LZ4 compressed when that's smaller.
+void save_raw_texture(const char* filename, ImageBuffer* img) {
+  char path[MAX_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s%s", RESOURCE_FOLDER, filename);
+
+  size_t   pixelSize = (size_t)img->width * img->height * img->channels;
+  uint8_t* compressed = (uint8_t*)malloc(lz4_compress_bound(pixelSize));
+  size_t   compressedSize = lz4_compress(img->data, pixelSize, compressed);
+  bool     useCompressed = compressedSize < pixelSize;
+
+  RawTextureHeader header = {
+      .magic = RAW_TEXTURE_MAGIC,
+      .version = RAW_TEXTURE_VERSION,
+      .width = (uint32_t)img->width,
+      .height = (uint32_t)img->height,
+      .format = RAW_TEXTURE_FORMAT_R8G8B8A8,
+      .mipmaps = 1,
+      .compression = useCompressed ? RAW_TEXTURE_LZ4 : RAW_TEXTURE_UNCOMPRESSED,
+      .dataOffset = RAW_TEXTURE_DATA_ALIGNMENT,
+      .dataSize = useCompressed ? compressedSize : pixelSize,
+      .pixelSize = pixelSize,
+  };
+  uint8_t padding[RAW_TEXTURE_DATA_ALIGNMENT - sizeof(RawTextureHeader)] = {0};
+
+  FILE* file = fopen(path, "wb");
+  bool  written = file &&
+                 fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 fwrite(padding, sizeof(padding), 1, file) == 1 &&
+                 fwrite(useCompressed ? compressed : img->data, 1, header.dataSize, file) == header.dataSize;
+  if (file) fclose(file);
+  free(compressed);
+
+  if (!written) {
+    nob_log(NOB_ERROR, "Failed to write raw texture file: %s", path);
+    exit(1);
+  }
+  nob_log(NOB_INFO, "Successfully saved raw texture: %s (%zu of %zu bytes)", path, (size_t)header.dataSize, pixelSize);
+}
+
+void build_texture_atlas(const AtlasManifestEntry* atlas) {
+  const char* atlas_src_folder = atlas->source_folder;
+  const int   MAX_SPRITES = atlas->max_sprites;
+  bool        shouldBuild = check_should_build_atlas_and_compute_hashes(atlas->image_file, atlas->texture_file, atlas->meta_file, atlas->meta_text_file, atlas->sprites_header, atlas_src_folder);
   if (!shouldBuild) {
     nob_log(NOB_INFO, "No changes detected for atlas path: %s, skipping build", atlas_src_folder);
     return;
@@ -285,7 +635,7 @@ void build_texture_atlas(const char* atlas_img_filename, const char* atlas_metad
   stbrp_context context;
   stbrp_node    nodes[256];
 
-  stbrp_init_target(&context, atlas_width, atlas_height, nodes, 256);
+  stbrp_init_target(&context, atlas->size, atlas->size, nodes, 256);
 
   stbrp_rect rects[MAX_SPRITES];
   for (int i = 0; i < spriteCount; i++) {
@@ -304,7 +654,7 @@ void build_texture_atlas(const char* atlas_img_filename, const char* atlas_metad
       };
     }
 
-    ImageBuffer atlasImage = CreateBlankImage(atlas_width, atlas_height, 4);
+    ImageBuffer atlasImage = CreateBlankImage(atlas->size, atlas->size, 4);
 
     for (int i = 0; i < spriteCount; i++) {
       NOB_SpriteMetadata sprite = sprites[i];
@@ -314,15 +664,18 @@ void build_texture_atlas(const char* atlas_img_filename, const char* atlas_metad
     }
 
     char atlasPath[MAX_PATH_LENGTH];
-    snprintf(atlasPath, sizeof(atlasPath), "%s%s", RESOURCE_FOLDER, atlas_img_filename);
+    snprintf(atlasPath, sizeof(atlasPath), "%s%s", RESOURCE_FOLDER, atlas->image_file);
     SaveImageBuffer(&atlasImage, atlasPath);
-    FreeImageBuffer(&atlasImage);
     nob_log(NOB_INFO, "Successfully saved atlas image: %s", atlasPath);
+    save_raw_texture(atlas->texture_file, &atlasImage);
+    FreeImageBuffer(&atlasImage);
 
     // Save metadata
-    save_atlas_metadata(atlas_metadata_filename, sprites, spriteCount);
+    save_atlas_metadata(atlas->meta_file, sprites, spriteCount);
+    save_atlas_metadata_text(atlas->meta_text_file, sprites, spriteCount);
+    save_atlas_sprites_header(atlas->sprites_header, atlas->sprites_macro, atlas->sprite_id_prefix, atlas_src_folder, sprites, spriteCount);
   } else {
-    nob_log(NOB_ERROR, "Failed to pack textures!");
+    nob_log(NOB_ERROR, "Failed to pack textures for atlas: %s", atlas->id);
     exit(1);
   }
 }
@@ -352,17 +705,58 @@ bool delete_folder_recursive(const char* directory_path) {
   return true;
 }
 
+// Includes every atlas's sprites header, so game_defines.h needs no edit per atlas. Left alone
+// when unchanged, like the other outputs of an up to date atlas.
+void save_atlas_sprites_include_header() {
+  Nob_String_Builder header = {0};
+  nob_sb_append_cstr(&header, "// Generated by nob's sprite packer from src/build_defines.h's ATLAS_MANIFEST, don't edit.\n");
+  nob_sb_append_cstr(&header, "#ifndef ATLAS_SPRITES_H\n#define ATLAS_SPRITES_H\n\n");
+  for (int i = 0; i < ATLAS_MANIFEST_COUNT; i++) {
+    nob_sb_append_cstr(&header, nob_temp_sprintf("#include \"%s\"\n", ATLAS_MANIFEST_ENTRIES[i].sprites_header));
+  }
+  nob_sb_append_cstr(&header, "\n#endif // !ATLAS_SPRITES_H\n");
+  nob_temp_reset();
+
+  const char*        path = GENERATED_FOLDER ATLAS_SPRITES_INCLUDE_HEADER;
+  Nob_String_Builder current = {0};
+  bool               unchanged = nob_file_exists(path) == 1 && nob_read_entire_file(path, &current) && current.count == header.count && memcmp(current.items, header.items, header.count) == 0;
+  if (!unchanged && !nob_write_entire_file(path, header.items, header.count)) exit(1);
+  nob_sb_free(current);
+  nob_sb_free(header);
+}
+
 // ::COMMANDS
-void execute_cmd_sprite_packer() {
-  build_texture_atlas(
-      MAIN_ATLAS_IMAGE_FILE,
-      MAIN_ATLAS_META_FILE,
-      "mainAtlas",
-      MAIN_ATLAS_SIZE,
-      MAIN_ATLAS_SIZE,
-      MAIN_ATLAS_MAX_SPRITES);
+// Packs one atlas from the manifest, run by execute_cmd_sprite_packer as `nob spritepack-atlas <ID>`.
+void execute_cmd_sprite_pack_atlas(const char* id) {
+  for (int i = 0; i < ATLAS_MANIFEST_COUNT; i++) {
+    if (strcmp(ATLAS_MANIFEST_ENTRIES[i].id, id) != 0) continue;
+    build_texture_atlas(&ATLAS_MANIFEST_ENTRIES[i]);
+    return;
+  }
+  nob_log(NOB_ERROR, "No atlas %s in the manifest", id);
+  exit(1);
+}
 
-  // TEMPLATE: Build additional sprite atlas as defined in src/build_defines
+// Every atlas in the manifest packs in its own nob process, SPRITE_PACK_MAX_JOBS at a time. The
+// packer leans on stb and nob's temp buffer, neither is thread safe, processes are free.
+void execute_cmd_sprite_packer(const char* nob_path) {
+  if (!nob_mkdir_if_not_exists(GENERATED_FOLDER)) exit(1);
+  Nob_Procs procs = {0};
+  Nob_Cmd   cmd = {0};
+  bool      success = true;
+  for (int i = 0; i < ATLAS_MANIFEST_COUNT; i++) {
+    nob_cmd_append(&cmd, nob_path, "spritepack-atlas", ATLAS_MANIFEST_ENTRIES[i].id);
+    nob_da_append(&procs, nob_cmd_run_async_and_reset(&cmd));
+    if (procs.count >= SPRITE_PACK_MAX_JOBS) success &= nob_procs_wait_and_reset(&procs);
+  }
+  success &= nob_procs_wait_and_reset(&procs);
+  nob_cmd_free(cmd);
+  nob_da_free(procs);
+  if (!success) {
+    nob_log(NOB_ERROR, "Sprite packer failed, see the atlas errors above.");
+    exit(1);
+  }
+  save_atlas_sprites_include_header();
 
   nob_log(NOB_INFO, "Sprite packer stage complete.");
 }
@@ -393,10 +787,203 @@ void execute_cmd_clean() {
   nob_log(NOB_INFO, "Successfully cleaned build folder.");
 }
 
-void execute_cmd_build(bool is_release) {
+// Resources execute_cmd_copy_resources copies, the game's resources/ folder.
+static bool is_runtime_resource(const char* filename, const char* filepath) {
+  if (strncmp(filename, ".", 1) == 0) return false; // Ignore anything that begins with '.'
+  const char* file_ext = GetFileExtension(filename);
+  if (file_ext == NULL) return false;
+  if (strcmp(file_ext, ".hash") == 0) return false;
+  return nob_get_file_type(filepath) == NOB_FILE_REGULAR;
+}
+
+// Writes every runtime resource into EMBEDDED_RESOURCES_HEADER as a byte array, for builds with
+// -DEMBED_RESOURCES=1. The game then loads them from memory instead of bin/resources/.
+void execute_cmd_embed_resources() {
+  Nob_File_Paths filenames = {0};
+  if (!nob_read_entire_dir(RESOURCE_FOLDER, &filenames)) exit(1);
+  if (!nob_mkdir_if_not_exists(GENERATED_FOLDER)) exit(1);
+
+  Nob_String_Builder header = {0};
+  Nob_String_Builder list = {0};
+  nob_sb_append_cstr(&header, "// Generated by nob embed from " RESOURCE_FOLDER ", don't edit.\n");
+  nob_sb_append_cstr(&header, "// X(fileName, data) for each resource, data is 16 byte aligned.\n");
+  nob_sb_append_cstr(&header, "#ifndef EMBEDDED_RESOURCES_H\n#define EMBEDDED_RESOURCES_H\n");
+  nob_sb_append_cstr(&list, "\n#define EMBEDDED_RESOURCES(X)");
+  int embedded = 0;
+  for (size_t i = 0; i < filenames.count; i++) {
+    const char* filename = filenames.items[i];
+    char        filepath[MAX_PATH_LENGTH];
+    snprintf(filepath, sizeof(filepath), "%s%s", RESOURCE_FOLDER, filename);
+    if (!is_runtime_resource(filename, filepath)) continue;
+
+    Nob_String_Builder data = {0};
+    if (!nob_read_entire_file(filepath, &data)) exit(1);
+    char symbol[MAX_PATH_LENGTH];
+    snprintf(symbol, sizeof(symbol), "EMBEDDED_%s", filename);
+    for (char* c = symbol; *c; c++) *c = isalnum((unsigned char)*c) ? (char)toupper((unsigned char)*c) : '_';
+
+    nob_sb_append_cstr(&header, nob_temp_sprintf("\nstatic _Alignas(16) const unsigned char %s[%zu] = {", symbol, data.count ? data.count : 1));
+    for (size_t b = 0; b < data.count; b++) {
+      char byte[8];
+      snprintf(byte, sizeof(byte), " 0x%02x,", (unsigned char)data.items[b]);
+      if (b % 16 == 0) nob_sb_append_cstr(&header, "\n ");
+      nob_sb_append_cstr(&header, byte);
+    }
+    nob_sb_append_cstr(&header, "\n};\n");
+    nob_sb_append_cstr(&list, nob_temp_sprintf(" \\\n  X(\"%s\", %s)", filename, symbol));
+    nob_sb_free(data);
+    embedded++;
+  }
+  nob_sb_append_buf(&header, list.items, list.count);
+  nob_sb_append_cstr(&header, "\n\n#endif // !EMBEDDED_RESOURCES_H\n");
+
+  char headerPath[MAX_PATH_LENGTH];
+  snprintf(headerPath, sizeof(headerPath), "%s%s", GENERATED_FOLDER, EMBEDDED_RESOURCES_HEADER);
+  if (!nob_write_entire_file(headerPath, header.items, header.count)) exit(1);
+  nob_sb_free(list);
+  nob_sb_free(header);
+  nob_log(NOB_INFO, "Embedded %d resources into %s", embedded, headerPath);
+}
+
+typedef struct PackFile {
+  char     path[MAX_PATH_LENGTH - sizeof(RESOURCE_FOLDER)]; // Relative to RESOURCE_FOLDER, '/' separated, as the game asks for it.
+  uint32_t hash;
+} PackFile;
+
+typedef struct PackFiles {
+  PackFile* items;
+  size_t    count;
+  size_t    capacity;
+} PackFiles;
+
+static int compare_pack_files_by_path(const void* a, const void* b) {
+  return strcmp(((const PackFile*)a)->path, ((const PackFile*)b)->path);
+}
+
+static int compare_pack_entries_by_hash(const void* a, const void* b) {
+  uint32_t x = ((const AssetPackEntry*)a)->pathHash, y = ((const AssetPackEntry*)b)->pathHash;
+  return x < y ? -1 : x > y;
+}
+
+static bool is_atlas_source_folder(const char* relative_path) {
+  for (int i = 0; i < ATLAS_MANIFEST_COUNT; i++) {
+    if (strcmp(ATLAS_MANIFEST_ENTRIES[i].source_folder, relative_path) == 0) return true;
+  }
+  return false;
+}
+
+// Runtime resources under RESOURCE_FOLDER, subfolders included (sounds, fonts, levels...), except
+// the atlases' source images: only their packed outputs ship.
+static void collect_pack_files(const char* relative_dir, PackFiles* files) {
+  char dir_path[MAX_PATH_LENGTH];
+  snprintf(dir_path, sizeof(dir_path), "%s%s", RESOURCE_FOLDER, relative_dir);
+  Nob_File_Paths filenames = {0};
+  if (!nob_read_entire_dir(dir_path, &filenames)) exit(1);
+
+  for (size_t i = 0; i < filenames.count; i++) {
+    const char* filename = filenames.items[i];
+    if (strncmp(filename, ".", 1) == 0) continue; // Ignore anything that begins with '.'
+    PackFile file = {0};
+    snprintf(file.path, sizeof(file.path), "%s%s%s", relative_dir, relative_dir[0] ? "/" : "", filename);
+    char filepath[MAX_PATH_LENGTH];
+    snprintf(filepath, sizeof(filepath), "%s%s", RESOURCE_FOLDER, file.path);
+
+    if (nob_get_file_type(filepath) == NOB_FILE_DIRECTORY) {
+      if (!is_atlas_source_folder(file.path)) collect_pack_files(file.path, files);
+      continue;
+    }
+    if (!is_runtime_resource(filename, filepath)) continue;
+    file.hash = ComputeCRC32((unsigned char*)file.path, (int)strlen(file.path));
+    nob_da_append(files, file);
+  }
+  nob_da_free(filenames);
+}
+
+// Formats the game reads straight from the mapping (atlas_format.h, texture_format.h). They stay
+// stored even when LZ4 would shrink them, a packed copy would cost a decompress and a heap copy.
+static bool is_read_in_place(const char* filename) {
+  const char* file_ext = GetFileExtension(filename);
+  return file_ext && (strcmp(file_ext, ".bin") == 0 || strcmp(file_ext, ".rtex") == 0);
+}
+
+// Writes every runtime resource into BUILD_FOLDER RESOURCE_PACK_FILE (pack_format.h). Files are
+// LZ4 compressed when that saves at least a quarter, unless the game reads them in place.
+void execute_cmd_pack_resources() {
+  PackFiles files = {0};
+  collect_pack_files("", &files);
+  qsort(files.items, files.count, sizeof(PackFile), compare_pack_files_by_path);
+
+  AssetPackHeader header = {
+      .magic = ASSET_PACK_MAGIC,
+      .version = ASSET_PACK_VERSION,
+      .entryCount = (uint32_t)files.count,
+      .entryOffset = sizeof(AssetPackHeader),
+  };
+  header.stringOffset = header.entryOffset + header.entryCount * (uint32_t)sizeof(AssetPackEntry);
+  for (size_t i = 0; i < files.count; i++) header.stringSize += (uint32_t)strlen(files.items[i].path) + 1;
+
+  AssetPackEntry*    entries = (AssetPackEntry*)calloc(files.count ? files.count : 1, sizeof(AssetPackEntry));
+  Nob_String_Builder blobs = {0}; // Everything from the first blob on.
+  uint64_t           blobs_offset = header.stringOffset + header.stringSize;
+  blobs_offset = (blobs_offset + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+  uint32_t path_offset = 0;
+  size_t   compressed = 0;
+  for (size_t i = 0; i < files.count; i++) {
+    PackFile*          file = &files.items[i];
+    char               filepath[MAX_PATH_LENGTH];
+    Nob_String_Builder data = {0};
+    snprintf(filepath, sizeof(filepath), "%s%s", RESOURCE_FOLDER, file->path);
+    if (!nob_read_entire_file(filepath, &data)) exit(1);
+
+    while (blobs.count % ASSET_PACK_ALIGNMENT != 0) nob_da_append(&blobs, 0);
+    AssetPackEntry* entry = &entries[i];
+    *entry = (AssetPackEntry){
+        .pathHash = file->hash,
+        .pathOffset = path_offset,
+        .compression = ASSET_PACK_UNCOMPRESSED,
+        .offset = blobs_offset + blobs.count,
+        .storedSize = data.count,
+        .size = data.count,
+    };
+    path_offset += (uint32_t)strlen(file->path) + 1;
+
+    uint8_t* lz4 = (uint8_t*)malloc(lz4_compress_bound(data.count));
+    size_t   lz4_size = data.count && !is_read_in_place(file->path) ? lz4_compress((const uint8_t*)data.items, data.count, lz4) : 0;
+    if (lz4_size && lz4_size <= data.count - data.count / 4) {
+      entry->compression = ASSET_PACK_LZ4;
+      entry->storedSize = lz4_size;
+      nob_sb_append_buf(&blobs, (const char*)lz4, lz4_size);
+      compressed++;
+    } else {
+      nob_sb_append_buf(&blobs, data.items, data.count);
+    }
+    free(lz4);
+    nob_sb_free(data);
+  }
+  qsort(entries, files.count, sizeof(AssetPackEntry), compare_pack_entries_by_hash); // The game binary searches the hashes.
+
+  Nob_String_Builder pack = {0};
+  nob_sb_append_buf(&pack, (const char*)&header, sizeof(header));
+  nob_sb_append_buf(&pack, (const char*)entries, files.count * sizeof(AssetPackEntry));
+  for (size_t i = 0; i < files.count; i++) nob_sb_append_buf(&pack, files.items[i].path, strlen(files.items[i].path) + 1);
+  while (pack.count < blobs_offset) nob_da_append(&pack, 0);
+  nob_sb_append_buf(&pack, blobs.items, blobs.count);
+
+  if (!nob_mkdir_if_not_exists(BUILD_FOLDER)) exit(1);
+  const char* pack_path = BUILD_FOLDER RESOURCE_PACK_FILE;
+  if (!nob_write_entire_file(pack_path, pack.items, pack.count)) exit(1);
+  nob_log(NOB_INFO, "Packed %zu resources (%zu LZ4 compressed) into %s, %zu bytes", files.count, compressed, pack_path, pack.count);
+  nob_sb_free(pack);
+  nob_sb_free(blobs);
+  free(entries);
+  nob_da_free(files);
+}
+
+void execute_cmd_build(bool is_release, bool embed_resources) {
   Nob_Cmd build_cmd = {0};
   if (!nob_mkdir_if_not_exists(BUILD_FOLDER)) exit(1);
   nob_cmd_append(&build_cmd, "cc", "-Wall", "-Wextra");
+  if (embed_resources) nob_cmd_append(&build_cmd, "-DEMBED_RESOURCES=1");
   if (is_release) {
     // TODO: Investigate what would be good here... maybe -O2?
     nob_cmd_append(&build_cmd, "-DDEBUG=0", "-O3", "-s"); // DEBUG FLAGS
@@ -406,7 +993,7 @@ void execute_cmd_build(bool is_release) {
   nob_cmd_append(&build_cmd, SRC_FOLDER "main.c");
 #ifdef _WIN32
   nob_cmd_append(&build_cmd, "-L", "lib_win/", "-lraylib");
-  nob_cmd_append(&build_cmd, "-lgdi32", "-lwinmm");
+  nob_cmd_append(&build_cmd, "-lgdi32", "-lwinmm", "-lpthread");
 #else
   nob_cmd_append(&build_cmd, "-L", "lib_mac/", "-lraylib");
   nob_cmd_append(&build_cmd, "-framework", "CoreVideo", "-framework", "IOKit", "-framework", "Cocoa", "-framework", "GLUT", "-framework", "OpenGL");
@@ -428,16 +1015,10 @@ void execute_cmd_copy_resources() {
 
   for (size_t i = 0; i < filenames.count; i++) {
     const char* filename = filenames.items[i];
-    if (strncmp(filename, ".", 1) == 0) continue; // Ignore anything that begins with '.'
     // TODO: Copy the other resources in directory such as future sound folders.
-    const char* file_ext = GetFileExtension(filename);
-    if (file_ext == NULL) continue;
-    if (strcmp(file_ext, ".hash") == 0) continue;
-
     char filepath[MAX_PATH_LENGTH];
     snprintf(filepath, sizeof(filepath), "%s%s", RESOURCE_FOLDER, filename);
-    Nob_File_Type filetype = nob_get_file_type(filepath);
-    if (filetype != NOB_FILE_REGULAR) continue;
+    if (!is_runtime_resource(filename, filepath)) continue;
 
     char dest_path[MAX_PATH_LENGTH];
     snprintf(dest_path, sizeof(dest_path), "%s%s", dest_folder, filename);
@@ -447,9 +1028,10 @@ void execute_cmd_copy_resources() {
   nob_log(NOB_INFO, "Resources copied to build folder.");
 }
 
-void execute_cmd_run() {
+void execute_cmd_run(int argc, char** argv) {
   Nob_Cmd run_cmd = {0};
   nob_cmd_append(&run_cmd, "./" OUT_PATH);
+  for (int i = 0; i < argc; i++) nob_cmd_append(&run_cmd, argv[i]); // Forward extra args to the game.
   if (!nob_cmd_run_sync(run_cmd)) exit(1);
 }
 
@@ -458,6 +1040,10 @@ typedef enum {
   NOB_BUILD_RELEASE,
   NOB_CLEAN_ONLY,
   NOB_SPRITE_PACK_ONLY,
+  NOB_SPRITE_PACK_ATLAS,
+  NOB_BENCH,
+  NOB_BUILD_EMBEDDED,
+  NOB_PACK_ONLY,
 } BUILD_MODE;
 int main(int argc, char** argv) {
   NOB_GO_REBUILD_URSELF(argc, argv);
@@ -468,6 +1054,10 @@ int main(int argc, char** argv) {
     if (strcmp(build_param, "release") == 0) mode = NOB_BUILD_RELEASE;
     else if (strcmp(build_param, "clean") == 0) mode = NOB_CLEAN_ONLY;
     else if (strcmp(build_param, "spritepack") == 0) mode = NOB_SPRITE_PACK_ONLY;
+    else if (strcmp(build_param, "spritepack-atlas") == 0 && argc > 2) mode = NOB_SPRITE_PACK_ATLAS;
+    else if (strcmp(build_param, "bench") == 0) mode = NOB_BENCH;
+    else if (strcmp(build_param, "embed") == 0) mode = NOB_BUILD_EMBEDDED;
+    else if (strcmp(build_param, "pack") == 0) mode = NOB_PACK_ONLY;
     else {
       nob_log(NOB_ERROR, "Unrecognised build param: %s", build_param);
       exit(1);
@@ -477,25 +1067,54 @@ int main(int argc, char** argv) {
   switch (mode) {
     case NOB_BUILD_NORMAL: {
       execute_cmd_clean();
-      execute_cmd_sprite_packer();
-      execute_cmd_build(false);
+      execute_cmd_sprite_packer(argv[0]);
+      execute_cmd_build(false, false);
       execute_cmd_copy_resources();
-      execute_cmd_run();
+      execute_cmd_run(0, NULL);
       break;
     }
     case NOB_BUILD_RELEASE: {
       execute_cmd_clean();
-      execute_cmd_sprite_packer();
-      execute_cmd_build(true);
-      execute_cmd_copy_resources();
+      execute_cmd_sprite_packer(argv[0]);
+      execute_cmd_build(true, false);
+      execute_cmd_pack_resources();
+      break;
+    }
+    case NOB_BUILD_EMBEDDED: {
+      // Release build with every resource inside the executable, nothing to copy.
+      execute_cmd_clean();
+      execute_cmd_sprite_packer(argv[0]);
+      execute_cmd_embed_resources();
+      execute_cmd_build(true, true);
       break;
     }
     case NOB_CLEAN_ONLY: {
       execute_cmd_clean();
       break;
     }
+    case NOB_PACK_ONLY: {
+      execute_cmd_sprite_packer(argv[0]);
+      execute_cmd_pack_resources();
+      break;
+    }
     case NOB_SPRITE_PACK_ONLY: {
-      execute_cmd_sprite_packer();
+      execute_cmd_sprite_packer(argv[0]);
+      break;
+    }
+    case NOB_SPRITE_PACK_ATLAS: {
+      execute_cmd_sprite_pack_atlas(argv[2]);
+      break;
+    }
+    case NOB_BENCH: {
+      execute_cmd_clean();
+      execute_cmd_sprite_packer(argv[0]);
+      execute_cmd_build(true, false);
+      execute_cmd_pack_resources();
+      // e.g. `nob bench 100000 --frames 600 --headless`, everything after bench goes to the game.
+      char* bench_args[64] = {"--bench"};
+      int   bench_argc = 1;
+      for (int i = 2; i < argc && bench_argc < 64; i++) bench_args[bench_argc++] = argv[i];
+      execute_cmd_run(bench_argc, bench_args);
       break;
     }
     default: {
@@ -0,0 +1,346 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include "include/raylib.h"
+#include "include/rlgl.h"
+#include "build_defines.h"
+#include "game_defines.h"
+#include "mem_arena.h"
+#include "texture_cache.h"
+#include "texture_packer_utils.h"
+#include "utils.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// ::ASSET LOADER
+// Textures load in the background, so the window is up on the first frame and textures needed
+// later (e.g. on a level transition) stream in without a hitch:
+// - Loader threads read and decode into their own staging arena and never touch the GPU.
+// - UpdateAssetLoader, on the main thread between frames, uploads decoded images in row bands
+//   until the frame's time budget is spent, then points the texture's sprites at it.
+// Until then sprites draw textures[TEX_NIL] at their final size, so nothing jumps when the real
+// texture arrives. A texture that fails to load stays on the placeholder, with a warning.
+// Uploads make room in the texture budget first, and textures the cache evicted come back
+// through here too (UpdateTextureResidency, texture_cache.h).
+// NOTE: The loader has its own threads instead of job_system.h jobs: the main thread runs
+// queued jobs while it waits on frame tasks, so it would end up doing a decode mid frame.
+#define ASSET_LOADER_MAX_THREADS 4
+#define ASSET_LOADER_MAX_REQUESTS 128 // Power of 2. Loads queued or waiting for upload at once.
+#define ASSET_UPLOAD_BAND_BYTES (1024 * 1024) // Per UpdateTextureRec, a fraction of a millisecond.
+
+typedef enum AssetRequestState {
+  ASSET_REQUEST_FREE = 0,
+  ASSET_REQUEST_QUEUED,  // Waiting for or on a loader thread.
+  ASSET_REQUEST_DECODED, // Pixels ready to upload.
+  ASSET_REQUEST_FAILED,
+} AssetRequestState;
+
+typedef struct AssetRequest {
+  atomic_int    state; // AssetRequestState. Published with release, so the fields below are visible.
+  TextureID     texture;
+  TextureSource source;
+
+  // Filled by the loader thread.
+  Image      image;
+  MappedFile file; // Only while image points into it.
+  bool       heapPixels;
+  int        thread; // Whose staging arena holds the pixels.
+
+  // Upload progress, main thread.
+  Texture2D uploading;
+  int       uploadedRows;
+} AssetRequest;
+
+typedef struct AssetLoader AssetLoader;
+typedef struct AssetLoaderThread {
+  AssetLoader* loader;
+  int          index;
+  pthread_t    thread;
+  MemoryArena* staging;
+  atomic_int   stagedCount; // Its decoded requests not released yet. Staging is reset once it's 0.
+} AssetLoaderThread;
+
+struct AssetLoader {
+  AssetRequest      requests[ASSET_LOADER_MAX_REQUESTS];
+  AssetLoaderThread threads[ASSET_LOADER_MAX_THREADS];
+  int               threadCount;
+
+  // FIFO of request indices, guarded by mutex.
+  pthread_mutex_t mutex;
+  pthread_cond_t  wake;
+  uint32_t        queue[ASSET_LOADER_MAX_REQUESTS];
+  uint32_t        queueHead;
+  uint32_t        queueTail;
+  bool            running;
+
+  int uploading; // Request partway through its upload, -1 if none. Finished before any other starts.
+};
+
+// ::ASSET LOADER THREADS
+static MARK_IGNORE_UNUSED_FUNC void DecodeAssetRequest(AssetLoaderThread* thread, AssetRequest* request) {
+  if (atomic_load_explicit(&thread->stagedCount, memory_order_acquire) == 0) ResetArena(thread->staging); // Main thread is done with it.
+
+  request->thread = thread->index;
+  request->image = (Image){0};
+  if (request->source.rawFileName) request->image = LoadResourceRawImage(request->source.rawFileName, thread->staging, &request->file, &request->heapPixels);
+  if (!request->image.data && request->source.fileName) {
+    request->image = LoadResourceImage(request->source.fileName);
+    request->heapPixels = true;
+  }
+  atomic_fetch_add_explicit(&thread->stagedCount, 1, memory_order_relaxed);
+  atomic_store_explicit(&request->state, request->image.data ? ASSET_REQUEST_DECODED : ASSET_REQUEST_FAILED, memory_order_release);
+}
+
+static MARK_IGNORE_UNUSED_FUNC void* AssetLoaderThreadMain(void* param) {
+  AssetLoaderThread* thread = (AssetLoaderThread*)param;
+  AssetLoader*       loader = thread->loader;
+  pthread_mutex_lock(&loader->mutex);
+  while (true) {
+    while (loader->running && loader->queueHead == loader->queueTail) pthread_cond_wait(&loader->wake, &loader->mutex);
+    if (!loader->running) break;
+    AssetRequest* request = &loader->requests[loader->queue[loader->queueHead++ & (ASSET_LOADER_MAX_REQUESTS - 1)]];
+    pthread_mutex_unlock(&loader->mutex);
+    DecodeAssetRequest(thread, request);
+    pthread_mutex_lock(&loader->mutex);
+  }
+  pthread_mutex_unlock(&loader->mutex);
+  return 0;
+}
+
+// ::ASSET LOADER API
+static MARK_IGNORE_UNUSED_FUNC size_t AssetLoaderArenaSize(int threadCount, size_t stagingSize) {
+  if (threadCount > ASSET_LOADER_MAX_THREADS) threadCount = ASSET_LOADER_MAX_THREADS;
+  size_t perThread = AlignUpMaxAlignment(sizeof(MemoryArena)) + AlignUpMaxAlignment(stagingSize);
+  return AlignUpMaxAlignment(sizeof(AssetLoader)) + perThread * (size_t)threadCount;
+}
+
+// stagingSize is per thread. Images that don't fit are decoded into the heap instead.
+static MARK_IGNORE_UNUSED_FUNC AssetLoader* CreateAssetLoader(MemoryArena* arena, int threadCount, size_t stagingSize) {
+  if (threadCount < 1) threadCount = 1;
+  if (threadCount > ASSET_LOADER_MAX_THREADS) threadCount = ASSET_LOADER_MAX_THREADS;
+
+  AssetLoader* loader = PushType(arena, AssetLoader);
+  memset(loader, 0, sizeof(AssetLoader));
+  loader->threadCount = threadCount;
+  loader->running = true;
+  loader->uploading = -1;
+  pthread_mutex_init(&loader->mutex, 0);
+  pthread_cond_init(&loader->wake, 0);
+  for (int i = 0; i < threadCount; i++) {
+    AssetLoaderThread* thread = &loader->threads[i];
+    thread->loader = loader;
+    thread->index = i;
+    thread->staging = CreateSubMemArena(arena, stagingSize);
+    pthread_create(&thread->thread, 0, AssetLoaderThreadMain, thread);
+  }
+  return loader;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void ReleaseAssetRequest(AssetLoader* loader, AssetRequest* request) {
+  if (request->heapPixels) UnloadImage(request->image);
+  UnmapFile(&request->file);
+  atomic_fetch_sub_explicit(&loader->threads[request->thread].stagedCount, 1, memory_order_release);
+  request->image = (Image){0};
+  request->heapPixels = false;
+  request->uploading = (Texture2D){0};
+  request->uploadedRows = 0;
+  atomic_store_explicit(&request->state, ASSET_REQUEST_FREE, memory_order_relaxed);
+}
+
+static MARK_IGNORE_UNUSED_FUNC bool QueueTextureLoad(AssetLoader* loader, TextureID texture, TextureSource source) {
+  int slot = -1;
+  for (int i = 0; i < ASSET_LOADER_MAX_REQUESTS && slot < 0; i++) {
+    if (atomic_load_explicit(&loader->requests[i].state, memory_order_acquire) == ASSET_REQUEST_FREE) slot = i;
+  }
+  if (slot < 0) {
+    TraceLog(LOG_WARNING, "ASSETS: Too many loads in flight, dropped %s", source.fileName);
+    return false;
+  }
+
+  AssetRequest* request = &loader->requests[slot];
+  request->texture = texture;
+  request->source = source;
+  atomic_store_explicit(&request->state, ASSET_REQUEST_QUEUED, memory_order_relaxed);
+  textureCache.textures[texture].loading = true;
+  textureCache.textures[texture].wanted = false;
+
+  pthread_mutex_lock(&loader->mutex);
+  loader->queue[loader->queueTail++ & (ASSET_LOADER_MAX_REQUESTS - 1)] = (uint32_t)slot;
+  pthread_cond_signal(&loader->wake);
+  pthread_mutex_unlock(&loader->mutex);
+  return true;
+}
+
+// Main thread. Queues a texture and, until it's uploaded, points its sprites at the placeholder.
+// A texture that's already loaded keeps drawing until the new one replaces it.
+static MARK_IGNORE_UNUSED_FUNC bool RequestTextureLoad(AssetLoader* loader, TextureID texture, const char* rawFileName, const char* fileName, const AtlasSprite* table, int count, SpriteID wholeSprite) {
+  TextureSource source = {rawFileName, fileName, table, count, wholeSprite};
+  if (!QueueTextureLoad(loader, texture, source)) return false;
+
+  textureCache.textures[texture].failed = false;
+  if (!textureCache.textures[texture].resident) {
+    for (int i = 0; i < count; i++) {
+      sprites[table[i].id] = sprites[SPRITE_NIL];
+      sprites[table[i].id].size = (Vector2){table[i].rect.width, table[i].rect.height};
+    }
+    if (wholeSprite != SPRITE_NIL) sprites[wholeSprite] = sprites[SPRITE_NIL];
+  }
+  return true;
+}
+
+// Uploads the next band of rows, returns true once the whole image is on the GPU. Compressed
+// formats and mipmapped images can't be split by rows, they go in one call.
+static MARK_IGNORE_UNUSED_FUNC bool UploadAssetBand(AssetRequest* request) {
+  Image* image = &request->image;
+  if (image->format >= PIXELFORMAT_COMPRESSED_DXT1_RGB || image->mipmaps > 1) {
+    request->uploading = LoadTextureFromImage(*image);
+    return true;
+  }
+  if (request->uploadedRows == 0) {
+    unsigned int id = rlLoadTexture(NULL, image->width, image->height, image->format, 1);
+    request->uploading = (Texture2D){id, image->width, image->height, 1, image->format};
+    if (id == 0) return true;
+  }
+  int rowSize = GetPixelDataSize(image->width, 1, image->format);
+  int rows = ASSET_UPLOAD_BAND_BYTES / rowSize;
+  if (rows < 1) rows = 1;
+  if (rows > image->height - request->uploadedRows) rows = image->height - request->uploadedRows;
+  Rectangle band = {0, (float)request->uploadedRows, (float)image->width, (float)rows};
+  UpdateTextureRec(request->uploading, band, (uint8_t*)image->data + (size_t)request->uploadedRows * rowSize);
+  request->uploadedRows += rows;
+  return request->uploadedRows >= image->height;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void FinishAssetRequest(AssetRequest* request) {
+  Texture2D texture = request->uploading;
+  if (!IsTextureValid(texture)) {
+    TraceLog(LOG_WARNING, "ASSETS: Failed to upload %s", request->source.fileName);
+    textureCache.textures[request->texture].loading = false;
+    textureCache.textures[request->texture].failed = true;
+    return;
+  }
+  if (IsTextureValid(textures[request->texture])) UnloadTexture(textures[request->texture]); // Reloaded.
+  SetTextureResident(request->texture, texture, &request->source);
+  setupSpritesFromAtlas(request->texture, request->source.sprites, request->source.spriteCount);
+  if (request->source.wholeSprite != SPRITE_NIL) setupSpriteAsWholeTexture(request->source.wholeSprite, request->texture);
+}
+
+// Main thread, between frames. Uploads decoded textures until budgetMs is spent, at least one band
+// per call so loads always progress. Returns how many textures went live, e.g. to redraw cached
+// layers that use them.
+static MARK_IGNORE_UNUSED_FUNC int UpdateAssetLoader(AssetLoader* loader, double budgetMs) {
+  double start = GetTime();
+  int    finished = 0;
+  bool   uploadedAny = false;
+  for (int i = -1; i < ASSET_LOADER_MAX_REQUESTS; i++) {
+    int index = i < 0 ? loader->uploading : i; // The one last call's budget cut off goes first.
+    if (index < 0) continue;
+    AssetRequest* request = &loader->requests[index];
+    int           state = atomic_load_explicit(&request->state, memory_order_acquire);
+    if (state == ASSET_REQUEST_FAILED) {
+      TraceLog(LOG_WARNING, "ASSETS: Failed to load %s, keeping the placeholder", request->source.fileName);
+      textureCache.textures[request->texture].loading = false;
+      textureCache.textures[request->texture].failed = true;
+      ReleaseAssetRequest(loader, request);
+      continue;
+    }
+    if (state != ASSET_REQUEST_DECODED) continue;
+
+    if (loader->uploading != index) {
+      Image* image = &request->image;
+      uint64_t bytes = GetTextureBytes((Texture2D){0, image->width, image->height, image->mipmaps, image->format});
+      if (textureCache.textures[request->texture].resident) bytes = 0; // Replaces itself.
+      if (!MakeTextureRoom(bytes)) TraceLog(LOG_WARNING, "ASSETS: %s goes over the texture budget, everything resident is in use", request->source.fileName);
+    }
+    loader->uploading = index;
+    bool done = false;
+    while (!done) {
+      if (uploadedAny && (GetTime() - start) * 1000.0 >= budgetMs) return finished;
+      done = UploadAssetBand(request);
+      uploadedAny = true;
+    }
+    loader->uploading = -1;
+    FinishAssetRequest(request);
+    ReleaseAssetRequest(loader, request);
+    finished++;
+  }
+  return finished;
+}
+
+// Main thread, once per frame after the draws. Reloads evicted textures that were used again,
+// then evicts whatever still doesn't fit the budget.
+static MARK_IGNORE_UNUSED_FUNC void UpdateTextureResidency(AssetLoader* loader) {
+  for (int i = 0; i < TEX_COUNT; i++) {
+    TextureResidency* residency = &textureCache.textures[i];
+    if (!residency->wanted) continue;
+    residency->wanted = false;
+    if (QueueTextureLoad(loader, (TextureID)i, residency->source)) textureCache.stats.reloads++;
+  }
+  EndTextureCacheFrame();
+}
+
+static MARK_IGNORE_UNUSED_FUNC bool IsAssetLoaderIdle(AssetLoader* loader) {
+  for (int i = 0; i < ASSET_LOADER_MAX_REQUESTS; i++) {
+    if (atomic_load_explicit(&loader->requests[i].state, memory_order_acquire) != ASSET_REQUEST_FREE) return false;
+  }
+  return true;
+}
+
+// Blocks until every queued texture is uploaded, for runs that need them all from the first frame (benchmarks).
+static MARK_IGNORE_UNUSED_FUNC int WaitForAssetLoader(AssetLoader* loader) {
+  int finished = 0;
+  while (!IsAssetLoaderIdle(loader)) {
+    finished += UpdateAssetLoader(loader, 1000.0);
+    sched_yield();
+  }
+  return finished;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void DestroyAssetLoader(AssetLoader* loader) {
+  pthread_mutex_lock(&loader->mutex);
+  loader->running = false;
+  pthread_cond_broadcast(&loader->wake);
+  pthread_mutex_unlock(&loader->mutex);
+  for (int i = 0; i < loader->threadCount; i++) pthread_join(loader->threads[i].thread, 0);
+
+  for (int i = 0; i < ASSET_LOADER_MAX_REQUESTS; i++) {
+    AssetRequest* request = &loader->requests[i];
+    int           state = atomic_load_explicit(&request->state, memory_order_acquire);
+    if (state == ASSET_REQUEST_DECODED || state == ASSET_REQUEST_FAILED) {
+      if (IsTextureValid(request->uploading)) UnloadTexture(request->uploading); // Partway through.
+      ReleaseAssetRequest(loader, request);
+    }
+  }
+  pthread_cond_destroy(&loader->wake);
+  pthread_mutex_destroy(&loader->mutex);
+}
+
+// ::TEXTURES
+// Only the placeholder loads up front, everything else is queued. Add new textures here.
+void LoadAllTexturesAndSprites(AssetLoader* loader) {
+  { // Placeholder, drawn by every sprite whose texture isn't in yet.
+    SetTextureResident(TEX_NIL, LoadResourceTexture("missing.png"), NULL);
+    setupSpriteAsWholeTexture(SPRITE_NIL, TEX_NIL);
+    for (int i = 1; i < SPRITE_COUNT; i++) sprites[i] = sprites[SPRITE_NIL];
+    SetTextureResident(TEX_FONT_DEFAULT, GetFontDefault().texture, NULL);
+  }
+
+  // The single level holds everything for the whole run. A level streaming its own atlases would
+  // AcquireTexture them on entry and ReleaseTexture them on exit, so they're the first to go.
+  RequestTextureLoad(loader, AcquireTexture(TEX_RAYLIB_LOGO), NULL, "Raylib_logo.png", NULL, 0, SPRITE_RAYLIB_LOGO);
+
+  // Every atlas in the manifest, decoded in parallel by the loader threads.
+  for (int i = 0; i < ATLAS_COUNT; i++) {
+    const AtlasInfo* atlas = &ATLASES[i];
+    RequestTextureLoad(loader, AcquireTexture(atlas->texture), atlas->textureFile, atlas->imageFile, atlas->sprites, atlas->spriteCount, SPRITE_NIL);
+#if DEBUG
+    CheckAtlasSpritesMatchMeta(atlas->metaFile, atlas->sprites, atlas->spriteCount);
+#endif
+  }
+}
+
+#endif // !ASSET_LOADER_H
@@ -0,0 +1,95 @@
+#ifndef ATLAS_FORMAT_H
+#define ATLAS_FORMAT_H
+
+#include "utils.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ::ATLAS FORMAT
+// Binary sprite atlas metadata, written by nob's sprite packer and mapped straight into memory
+// by the game (file_map.h). Nothing is parsed or copied, lookups read the mapping in place:
+//   AtlasMetaHeader   at offset 0
+//   displacements     bucketCount uint32_t at bucketOffset
+//   AtlasMetaRect     spriteCount entries of rectStride bytes at rectOffset, in hash slot order
+//   string pool       stringSize bytes at stringOffset, nul terminated names
+// Values are little endian, rects are pixels in the atlas image.
+// Names are found through a minimal perfect hash (hash and displace) the packer builds: the
+// name's CRC32 picks a bucket, the bucket's displacement turns the CRC32 into the name's slot
+// in the rect table. A lookup is one CRC32 and one compare, whatever the sprite count.
+// NOTE: Shared with nob.c, so no raylib in here. ComputeCRC32 comes from raylib in the game and
+// from nob_src/raylib_extracts.h in the packer, include one of them first.
+#define ATLAS_META_MAGIC 0x534C5441u // "ATLS"
+#define ATLAS_META_VERSION 2
+#define ATLAS_META_SPRITES_PER_BUCKET 4
+
+typedef struct AtlasMetaHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t spriteCount;
+  uint32_t bucketCount;
+  uint32_t bucketOffset; // From the start of the file.
+  uint32_t rectStride;   // sizeof(AtlasMetaRect) when written.
+  uint32_t rectOffset;
+  uint32_t stringOffset;
+  uint32_t stringSize;
+  uint32_t reserved;
+} AtlasMetaHeader;
+
+typedef struct AtlasMetaRect {
+  float    x, y, width, height; // Same layout as raylib's Rectangle.
+  uint32_t nameOffset;          // Into the string pool.
+  uint32_t nameLength;          // Without the nul.
+  uint32_t nameHash;            // ComputeCRC32 of the name.
+} AtlasMetaRect;
+
+// Slot for a name hash under a bucket's displacement. The packer tries displacements until
+// every name in the bucket lands in a free slot.
+static MARK_IGNORE_UNUSED_FUNC uint32_t GetAtlasMetaSlot(uint32_t hash, uint32_t displacement, uint32_t slotCount) {
+  uint32_t x = hash ^ (displacement * 0x9E3779B9u);
+  x ^= x >> 16; // murmur3 finalizer, so nearby displacements land far apart.
+  x *= 0x85EBCA6Bu;
+  x ^= x >> 13;
+  x *= 0xC2B2AE35u;
+  x ^= x >> 16;
+  return x % slotCount;
+}
+
+// Checks the header and that every table lies inside the data. Returns NULL if it doesn't, or if
+// the file is from a different version of the packer.
+static MARK_IGNORE_UNUSED_FUNC const AtlasMetaHeader* GetAtlasMeta(const void* data, size_t size) {
+  if (!data || size < sizeof(AtlasMetaHeader)) return NULL;
+  const AtlasMetaHeader* header = (const AtlasMetaHeader*)data;
+  if (header->magic != ATLAS_META_MAGIC || header->version != ATLAS_META_VERSION) return NULL;
+  if (header->spriteCount > 0 && header->bucketCount == 0) return NULL;
+  if (header->bucketOffset % sizeof(uint32_t) != 0 || (uint64_t)header->bucketOffset + (uint64_t)header->bucketCount * sizeof(uint32_t) > size) return NULL;
+  if (header->rectStride != sizeof(AtlasMetaRect) || header->rectOffset % sizeof(uint32_t) != 0) return NULL;
+  if ((uint64_t)header->rectOffset + (uint64_t)header->spriteCount * header->rectStride > size) return NULL;
+  if (header->stringSize == 0 || (uint64_t)header->stringOffset + header->stringSize > size) return NULL;
+  if (((const char*)data)[header->stringOffset + header->stringSize - 1] != '\0') return NULL; // So no name can run off the end.
+  return header;
+}
+
+static MARK_IGNORE_UNUSED_FUNC const AtlasMetaRect* GetAtlasMetaRects(const AtlasMetaHeader* header) {
+  return (const AtlasMetaRect*)((const uint8_t*)header + header->rectOffset);
+}
+
+// Checked here rather than in GetAtlasMeta, so loading doesn't touch every rect. "" if out of range.
+static MARK_IGNORE_UNUSED_FUNC const char* GetAtlasMetaName(const AtlasMetaHeader* header, const AtlasMetaRect* rect) {
+  if (rect->nameOffset >= header->stringSize) return "";
+  return (const char*)header + header->stringOffset + rect->nameOffset;
+}
+
+static MARK_IGNORE_UNUSED_FUNC const AtlasMetaRect* FindAtlasMetaRect(const AtlasMetaHeader* header, const char* name) {
+  if (header->spriteCount == 0) return NULL;
+  size_t          length = strlen(name);
+  uint32_t        hash = ComputeCRC32((unsigned char*)name, (int)length);
+  const uint32_t* displacements = (const uint32_t*)((const uint8_t*)header + header->bucketOffset);
+  uint32_t        slot = GetAtlasMetaSlot(hash, displacements[hash % header->bucketCount], header->spriteCount);
+  // Names that were never packed land on some other sprite's slot, hence the compare.
+  const AtlasMetaRect* rect = &GetAtlasMetaRects(header)[slot];
+  if (rect->nameHash != hash || rect->nameLength != length || strcmp(GetAtlasMetaName(header, rect), name) != 0) return NULL;
+  return rect;
+}
+
+#endif // !ATLAS_FORMAT_H
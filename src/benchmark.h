@@ -0,0 +1,339 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "include/raylib.h"
+#include "game_defines.h"
+#include "mem_arena.h"
+#include "entity_store.h"
+#include "spatial_grid.h"
+#include "job_system.h"
+#include "simd_kernels.h"
+#include "culling.h"
+#include "sprite_batch.h"
+#include "render_stats.h"
+#include "y_sort.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ::BENCHMARK
+// Sprite stress-test scene. Enabled from the command line, e.g.
+//   my-raylib-game --bench 100000 --frames 600 --headless --out bench.csv
+// --world N spreads the sprites over N x N screens so most of them are culled.
+// --ysort draws them in Y order (y_sort.h) instead of batched by texture.
+// Runs for a fixed number of frames and writes one csv row per frame plus a summary,
+// so renderer and simulation changes can be compared on the exact same workload.
+#define BENCH_MIN_SPRITES 1000
+#define BENCH_MAX_SPRITES 1000000
+#define BENCH_DEFAULT_SPRITES 10000
+#define BENCH_DEFAULT_FRAMES 600
+#define BENCH_DEFAULT_OUTPUT "bench_results.csv"
+#define BENCH_RANDOM_SEED 1337
+#define BENCH_COLLIDER_RADIUS 4.0f // Bullet sized, the 128px sprites would make everything overlap.
+#define BENCH_GRID_CELL_SIZE 8.0f
+#define BENCH_PAIRS_PER_SPRITE 8 // Pair buffer size, see BenchmarkFrameArenaSize.
+#define BENCH_DEFAULT_GRAIN_SIZE 16384
+#define BENCH_MAX_WORLD_SCALE 64
+
+typedef struct BenchmarkConfig {
+  bool        enabled;
+  bool        headless; // Hidden window, draws are recorded but never handed to raylib.
+  bool        collide;  // Also run the spatial grid broadphase every frame.
+  bool        ysort;    // Draw in Y order instead of by texture.
+  int         grainSize; // Entities per job when updating in parallel.
+  int         worldScale; // World is worldScale x worldScale screens.
+  int         spriteCount;
+  int         frameCount;
+  const char* outputPath;
+} BenchmarkConfig;
+
+typedef struct BenchmarkFrameStats {
+  double   updateMs;
+  double   broadphaseMs;
+  uint32_t pairCount;
+  bool     pairsTruncated; // Pair buffer ran out, pairCount is short.
+  double   drawMs;
+  double   sortMs; // Y sort, part of drawMs.
+  uint32_t spriteCount; // Sprites that made it into the batch.
+  uint32_t batchCount;  // Texture runs, each one rlSetTexture.
+  uint32_t culledCount;
+  size_t   memoryUsed;
+  double   criticalPathMs;
+  uint32_t drawCalls; // render_stats.h, headless runs leave the bench sprites out.
+  uint32_t batchFlushes;
+  uint32_t vertices;
+  uint32_t textureSwitches;
+} BenchmarkFrameStats;
+
+typedef struct BenchmarkScene {
+  BenchmarkConfig config;
+  MemoryArena*    arena;
+  MemoryArena*    frameArena; // Reset every update. Separate from the game's so both can update concurrently.
+
+  Rectangle        bounds;
+  EntityStore*     entities;
+  Vector2          spriteHalfExtent; // Largest sprite, for culling by centre point.
+  SpatialGrid*     grid; // Last update's broadphase grid with --collide, lives in frameArena.
+  SpriteBatch*     batch; // Headless runs build it but never submit it.
+  YSortIndex*      ysort; // With --ysort, over every entity so the order carries over between frames.
+
+  int                  frameIndex;
+  int                  threadCount;
+  BenchmarkFrameStats* frameStats;
+} BenchmarkScene;
+
+BenchmarkConfig ParseBenchmarkArgs(int argc, char** argv) {
+  BenchmarkConfig config = {
+      .enabled = false,
+      .headless = false,
+      .collide = false,
+      .ysort = false,
+      .grainSize = BENCH_DEFAULT_GRAIN_SIZE,
+      .worldScale = 1,
+      .spriteCount = BENCH_DEFAULT_SPRITES,
+      .frameCount = BENCH_DEFAULT_FRAMES,
+      .outputPath = BENCH_DEFAULT_OUTPUT,
+  };
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool        hasValue = i + 1 < argc;
+    if (strcmp(arg, "--bench") == 0) {
+      config.enabled = true;
+      if (hasValue && argv[i + 1][0] != '-') config.spriteCount = atoi(argv[++i]);
+    } else if (strcmp(arg, "--frames") == 0 && hasValue) config.frameCount = atoi(argv[++i]);
+    else if (strcmp(arg, "--out") == 0 && hasValue) config.outputPath = argv[++i];
+    else if (strcmp(arg, "--headless") == 0) config.headless = true;
+    else if (strcmp(arg, "--collide") == 0) config.collide = true;
+    else if (strcmp(arg, "--ysort") == 0) config.ysort = true;
+    else if (strcmp(arg, "--grain") == 0 && hasValue) config.grainSize = atoi(argv[++i]);
+    else if (strcmp(arg, "--world") == 0 && hasValue) config.worldScale = atoi(argv[++i]);
+    else TraceLog(LOG_WARNING, "Ignoring unrecognised argument: %s", arg);
+  }
+
+  if (config.headless) config.enabled = true;
+  if (config.spriteCount < BENCH_MIN_SPRITES) config.spriteCount = BENCH_MIN_SPRITES;
+  if (config.spriteCount > BENCH_MAX_SPRITES) config.spriteCount = BENCH_MAX_SPRITES;
+  if (config.frameCount < 1) config.frameCount = 1;
+  if (config.grainSize < 1) config.grainSize = 1;
+  if (config.worldScale < 1) config.worldScale = 1;
+  if (config.worldScale > BENCH_MAX_WORLD_SCALE) config.worldScale = BENCH_MAX_WORLD_SCALE;
+  return config;
+}
+
+// Frame arena has to hold the broadphase grid plus room for the pairs it finds. Pairs past
+// BENCH_PAIRS_PER_SPRITE on average are dropped, frames that hit it are counted in the results.
+size_t BenchmarkFrameArenaSize(BenchmarkConfig config) {
+  size_t count = (size_t)config.spriteCount;
+  size_t cullBytes = AlignUpMaxAlignment(sizeof(uint32_t) * count) + AlignUpMaxAlignment(sizeof(uint8_t) * count);
+  size_t collideBytes = SpatialGridArenaSize((uint32_t)count) + AlignUpMaxAlignment(sizeof(SpatialPair) * BENCH_PAIRS_PER_SPRITE * count);
+  return 64 * 1024 + cullBytes + (config.collide ? collideBytes : 0);
+}
+
+// NOTE: The scene owns its own arena sized for the requested count, 1M sprites does not fit in arenaMain.
+// screenBounds is scaled up by --world around its centre.
+BenchmarkScene* CreateBenchmarkScene(BenchmarkConfig config, Rectangle screenBounds) {
+  float     scale = (float)config.worldScale;
+  Rectangle bounds = (Rectangle){
+      screenBounds.x * scale,
+      screenBounds.y * scale,
+      screenBounds.width * scale,
+      screenBounds.height * scale};
+  size_t arenaSize = AlignUpMaxAlignment(sizeof(BenchmarkScene)) +
+                     EntityStoreArenaSize(config.spriteCount) +
+                     SpriteBatchArenaSize(config.spriteCount) +
+                     (config.ysort ? YSortIndexArenaSize(config.spriteCount) : 0) +
+                     AlignUpMaxAlignment(sizeof(BenchmarkFrameStats) * config.frameCount);
+  MemoryArena* arena = CreateMemoryArena(arenaSize);
+
+  BenchmarkScene* scene = PushType(arena, BenchmarkScene);
+  scene->config = config;
+  scene->arena = arena;
+  scene->frameArena = CreateMemoryArena(BenchmarkFrameArenaSize(config));
+  scene->bounds = bounds;
+  Vector2 size1 = sprites[SPRITE_MAIN_PLAYER_1].size, size2 = sprites[SPRITE_MAIN_PLAYER_2].size;
+  scene->spriteHalfExtent = Vector2Scale(Vector2Max(size1, size2), 0.5f);
+  scene->entities = CreateEntityStore(arena, config.spriteCount);
+  scene->batch = CreateSpriteBatch(arena, config.spriteCount);
+  if (config.ysort) scene->ysort = CreateYSortIndex(arena, config.spriteCount);
+  scene->frameStats = PushArray(arena, config.frameCount, BenchmarkFrameStats);
+
+  // Fixed seed so every run spawns the exact same workload.
+  SetRandomSeed(BENCH_RANDOM_SEED);
+  const int MAX_SPEED = 200;
+  for (int i = 0; i < config.spriteCount; i++) {
+    Vector2 pos = (Vector2){
+        bounds.x + (float)GetRandomValue(0, (int)bounds.width),
+        bounds.y + (float)GetRandomValue(0, (int)bounds.height)};
+    Vector2 vel = (Vector2){(float)GetRandomValue(-MAX_SPEED, MAX_SPEED), (float)GetRandomValue(-MAX_SPEED, MAX_SPEED)};
+    SpawnEntity(scene->entities, pos, vel, (i & 1) ? SPRITE_MAIN_PLAYER_2 : SPRITE_MAIN_PLAYER_1, ENTITY_FLAG_VISIBLE | ENTITY_FLAG_BOUNCE_IN_BOUNDS);
+  }
+
+  TraceLog(LOG_INFO, "BENCH: %d sprites, %d frames, %dx world%s%s", config.spriteCount, config.frameCount, config.worldScale, config.ysort ? ", y sorted" : "", config.headless ? ", headless" : "");
+  return scene;
+}
+
+void DestroyBenchmarkScene(BenchmarkScene* scene) {
+  DestroyMemoryArena(scene->frameArena);
+  DestroyMemoryArena(scene->arena);
+}
+
+bool IsBenchmarkComplete(BenchmarkScene* scene) { return scene->frameIndex >= scene->config.frameCount; }
+
+typedef struct BenchUpdateJobData {
+  BenchmarkScene* scene;
+  float           deltaTime;
+} BenchUpdateJobData;
+
+void BenchUpdateRange(void* data, uint32_t start, uint32_t end, MemoryArena* scratch) {
+  (void)scratch;
+  BenchUpdateJobData* job = (BenchUpdateJobData*)data;
+  IntegrateEntityVelocities(job->scene->entities, start, end, job->deltaTime);
+  BounceEntitiesInBounds(job->scene->entities, start, end, job->scene->bounds);
+}
+
+void UpdateBenchmarkScene(BenchmarkScene* scene, JobSystem* jobs, float deltaTime) {
+  MemoryArena* frameArena = scene->frameArena;
+  ResetArena(frameArena);
+
+  BenchmarkFrameStats* stats = &scene->frameStats[scene->frameIndex];
+  double               startTime = GetTime();
+  BenchUpdateJobData   jobData = {scene, deltaTime};
+  ParallelFor(jobs, scene->entities->count, (uint32_t)scene->config.grainSize, BenchUpdateRange, &jobData);
+  stats->updateMs = (GetTime() - startTime) * 1000.0;
+
+  scene->threadCount = jobs->threadCount;
+  scene->grid = 0;
+  if (scene->config.collide) {
+    startTime = GetTime();
+    EntityStore* entities = scene->entities;
+    SpatialGrid* grid = BuildSpatialGrid(frameArena, entities->posX, entities->posY, 0, BENCH_COLLIDER_RADIUS, entities->count, BENCH_GRID_CELL_SIZE);
+    SpatialPairs pairs = FindOverlappingPairs(grid, frameArena);
+    stats->broadphaseMs = (GetTime() - startTime) * 1000.0;
+    stats->pairCount = pairs.count;
+    stats->pairsTruncated = pairs.truncated;
+    ShrinkLastPush(frameArena, pairs.pairs, 0); // Only counted. A full buffer would leave nothing for culling.
+    scene->grid = grid;
+    if (pairs.truncated) TraceLog(LOG_WARNING, "BENCH: Pair buffer full on frame %d, pairs are undercounted", scene->frameIndex);
+  }
+}
+
+// Y sorted draw: everything is sorted (so the order carries over between frames), then the
+// visible ones are pushed in that order.
+uint32_t PushBenchmarkSpritesYSorted(BenchmarkScene* scene, Rectangle view, BenchmarkFrameStats* stats) {
+  EntityStore*    entities = scene->entities;
+  double          startTime = GetTime();
+  const uint32_t* order = UpdateYSortIndex(scene->ysort, entities->posY, entities->count);
+  stats->sortMs = (GetTime() - startTime) * 1000.0;
+
+  uint8_t* hits = PushArray(scene->frameArena, entities->count, uint8_t);
+  uint32_t visibleCount = BatchCheckCollisionPointRec(entities->posX, entities->posY, entities->count, ExpandRect(view, scene->spriteHalfExtent.x, scene->spriteHalfExtent.y), hits);
+  for (uint32_t k = 0; k < entities->count; k++) {
+    uint32_t i = order[k];
+    if (hits[i]) PushSprite(scene->batch, entities->spriteID[i], (Vector2){entities->posX[i], entities->posY[i]}, WHITE);
+  }
+  return visibleCount;
+}
+
+// NOTE: Must be called inside BeginMode2D. Headless runs only build the sprite batch.
+// Sprites outside view are culled first, through the broadphase grid when there is one.
+void DrawBenchmarkScene(BenchmarkScene* scene, Rectangle view) {
+  double               startTime = GetTime();
+  EntityStore*         entities = scene->entities;
+  SpriteBatch*         batch = scene->batch;
+  BenchmarkFrameStats* stats = &scene->frameStats[scene->frameIndex];
+  uint32_t             visibleCount;
+  BeginSpriteBatch(batch);
+  if (scene->ysort) {
+    visibleCount = PushBenchmarkSpritesYSorted(scene, view, stats);
+    BuildSpriteBatchInOrder(batch);
+  } else {
+    uint32_t* visible;
+    if (scene->grid) visibleCount = CullGridToView(scene->grid, scene->spriteHalfExtent, view, scene->frameArena, &visible);
+    else visibleCount = CullPointsToView(entities->posX, entities->posY, entities->count, scene->spriteHalfExtent, view, scene->frameArena, &visible);
+    for (uint32_t k = 0; k < visibleCount; k++) {
+      uint32_t i = visible[k];
+      PushSprite(batch, entities->spriteID[i], (Vector2){entities->posX[i], entities->posY[i]}, WHITE);
+    }
+    BuildSpriteBatch(batch);
+  }
+  if (!scene->config.headless) SubmitSpriteBatch(batch);
+
+  stats->drawMs = (GetTime() - startTime) * 1000.0;
+  stats->spriteCount = batch->count;
+  stats->batchCount = batch->runCount;
+  stats->culledCount = entities->count - visibleCount;
+}
+
+void EndBenchmarkFrame(BenchmarkScene* scene, size_t memoryUsed, double criticalPathMs, RenderStats render) {
+  BenchmarkFrameStats* stats = &scene->frameStats[scene->frameIndex];
+  stats->memoryUsed = memoryUsed + scene->arena->used + scene->frameArena->used;
+  stats->criticalPathMs = criticalPathMs;
+  stats->drawCalls = render.drawCalls;
+  stats->batchFlushes = render.batchFlushes;
+  stats->vertices = render.vertices;
+  stats->textureSwitches = render.textureSwitches;
+  scene->frameIndex++;
+}
+
+bool WriteBenchmarkResults(BenchmarkScene* scene) {
+  FILE* file = fopen(scene->config.outputPath, "w");
+  if (!file) {
+    TraceLog(LOG_ERROR, "BENCH: Failed to open results file: %s", scene->config.outputPath);
+    return false;
+  }
+
+  int      frameCount = scene->frameIndex;
+  double   totalUpdateMs = 0, totalDrawMs = 0, totalSortMs = 0, maxUpdateMs = 0, maxDrawMs = 0, maxSortMs = 0;
+  double   totalDrawCalls = 0;
+  uint32_t maxDrawCalls = 0;
+  int      truncatedFrames = 0;
+  for (int i = 0; i < frameCount; i++) {
+    BenchmarkFrameStats* stats = &scene->frameStats[i];
+    totalUpdateMs += stats->updateMs;
+    totalDrawMs += stats->drawMs;
+    totalSortMs += stats->sortMs;
+    if (stats->updateMs > maxUpdateMs) maxUpdateMs = stats->updateMs;
+    if (stats->drawMs > maxDrawMs) maxDrawMs = stats->drawMs;
+    if (stats->sortMs > maxSortMs) maxSortMs = stats->sortMs;
+    totalDrawCalls += stats->drawCalls;
+    if (stats->drawCalls > maxDrawCalls) maxDrawCalls = stats->drawCalls;
+    if (stats->pairsTruncated) truncatedFrames++;
+  }
+  if (frameCount == 0) frameCount = 1;
+
+  fprintf(file, "# sprites=%d frames=%d world=%d headless=%d collide=%d ysort=%d grain=%d threads=%d simd=%s debug=%d\n",
+      scene->config.spriteCount,
+      scene->frameIndex,
+      scene->config.worldScale,
+      scene->config.headless,
+      scene->config.collide,
+      scene->config.ysort,
+      scene->config.grainSize,
+      scene->threadCount,
+      SIMD_LEVEL_NAMES[GetSimdLevel()],
+      DEBUG);
+  fprintf(file, "# avg_update_ms=%.4f max_update_ms=%.4f avg_draw_ms=%.4f max_draw_ms=%.4f avg_sort_ms=%.4f max_sort_ms=%.4f avg_draw_calls=%.1f max_draw_calls=%u pair_truncated_frames=%d\n",
+      totalUpdateMs / frameCount,
+      maxUpdateMs,
+      totalDrawMs / frameCount,
+      maxDrawMs,
+      totalSortMs / frameCount,
+      maxSortMs,
+      totalDrawCalls / frameCount,
+      maxDrawCalls,
+      truncatedFrames);
+  fprintf(file, "frame,update_ms,broadphase_ms,pairs,draw_ms,sort_ms,sprites,batches,culled,memory_bytes,critical_path_ms,draw_calls,batch_flushes,vertices,texture_switches\n");
+  for (int i = 0; i < scene->frameIndex; i++) {
+    BenchmarkFrameStats* stats = &scene->frameStats[i];
+    fprintf(file, "%d,%.4f,%.4f,%u,%.4f,%.4f,%u,%u,%u,%zu,%.4f,%u,%u,%u,%u\n", i, stats->updateMs, stats->broadphaseMs, stats->pairCount, stats->drawMs, stats->sortMs, stats->spriteCount, stats->batchCount, stats->culledCount, stats->memoryUsed, stats->criticalPathMs, stats->drawCalls, stats->batchFlushes, stats->vertices, stats->textureSwitches);
+  }
+  fclose(file);
+
+  if (truncatedFrames > 0) TraceLog(LOG_WARNING, "BENCH: Pair buffer ran out on %d of %d frames, pair counts there are low", truncatedFrames, scene->frameIndex);
+  TraceLog(LOG_INFO, "BENCH: Results written to %s", scene->config.outputPath);
+  return true;
+}
+
+#endif // !BENCHMARK_H
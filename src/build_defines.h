@@ -1,11 +1,24 @@
 #ifndef BUILD_DEFINES_H
 #define BUILD_DEFINES_H
 
-#define MAIN_ATLAS_MAX_SPRITES 64
-#define MAIN_ATLAS_IMAGE_FILE "main_atlas.png"
-#define MAIN_ATLAS_META_FILE "main_atlas.txt"
-#define MAIN_ATLAS_SIZE 2048
+// ::ATLAS MANIFEST
+// Every sprite atlas, the only place to add one. X(ID, sourceFolder, fileName, size, maxSprites):
+// - ID names it in code: TEX_<ID>, SPRITE_<ID>_<sprite>, <ID>_ATLAS_SPRITES(X), <ID>_ATLAS_SPRITE_TABLE.
+// - sourceFolder is in resources/, one image per sprite.
+// - fileName is the base name of the packer's outputs, see the ATLAS_*_FILE macros below.
+// - size is the atlas width and height, maxSprites how many images the folder may hold.
+// `nob spritepack` packs them in parallel and the game queues them all on the asset loader.
+#define ATLAS_MANIFEST(X) \
+  X(MAIN, "mainAtlas", "main_atlas", 2048, 64)
 
-// TEMPLATE: Add more sprite atlases as desired.
+#define ATLAS_IMAGE_FILE(fileName) fileName ".png"
+#define ATLAS_TEXTURE_FILE(fileName) fileName ".rtex"       // Pre-decoded pixels the game loads, see texture_format.h.
+#define ATLAS_META_FILE(fileName) fileName ".bin"           // Loaded by the game, see atlas_format.h.
+#define ATLAS_META_TEXT_FILE(fileName) fileName ".txt"      // Same data, readable, for diffs.
+#define ATLAS_SPRITES_HEADER(fileName) fileName "_sprites.h" // In src/generated/, <ID>_ATLAS_SPRITES(X).
+#define ATLAS_SPRITES_INCLUDE_HEADER "atlas_sprites.h"      // In src/generated/, includes every atlas's sprites header.
+
+#define EMBEDDED_RESOURCES_HEADER "embedded_resources.h" // In src/generated/, written by `nob embed`.
+#define RESOURCE_PACK_FILE "resources.pak"                // Next to the executable, see pack_format.h.
 
 #endif
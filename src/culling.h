@@ -0,0 +1,84 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include "include/raylib.h"
+#include "mem_arena.h"
+#include "raymath_batch.h"
+#include "spatial_grid.h"
+#include "utils.h"
+#include <stdint.h>
+
+// ::CULLING
+// Drops sprites outside the camera's view before they are handed to raylib.
+// Two paths:
+// - CullGridToView: for things already in a SpatialGrid this frame. Only visits the cells the
+//   view covers, so the cost follows what is on screen, not the world size.
+// - CullRectsToView / CullPointsToView: SIMD test over every item, for sets without a grid.
+//   The ECS world sprites (BuildRenderPacket) go this way, see there why.
+// Both are conservative at most by the padding passed in, never drop something visible.
+typedef struct CullStats {
+  uint32_t visible;
+  uint32_t culled;
+} CullStats;
+
+// World space AABB of what the camera sees. With rotation this is the bounding box of the
+// rotated view, so a bit larger than the screen.
+static MARK_IGNORE_UNUSED_FUNC Rectangle GetCameraViewRect(Camera2D camera, float screenWidth, float screenHeight) {
+  Vector2 corners[4] = {
+      GetScreenToWorld2D((Vector2){0, 0}, camera),
+      GetScreenToWorld2D((Vector2){screenWidth, 0}, camera),
+      GetScreenToWorld2D((Vector2){0, screenHeight}, camera),
+      GetScreenToWorld2D((Vector2){screenWidth, screenHeight}, camera),
+  };
+  Vector2 min = corners[0], max = corners[0];
+  for (int i = 1; i < 4; i++) {
+    min = Vector2Min(min, corners[i]);
+    max = Vector2Max(max, corners[i]);
+  }
+  return (Rectangle){min.x, min.y, max.x - min.x, max.y - min.y};
+}
+
+static MARK_IGNORE_UNUSED_FUNC Rectangle ExpandRect(Rectangle rect, float padX, float padY) {
+  return (Rectangle){rect.x - padX, rect.y - padY, rect.width + padX * 2, rect.height + padY * 2};
+}
+
+// Turns a 0/1 hit array into the list of hit indices, in order.
+static MARK_IGNORE_UNUSED_FUNC uint32_t CompactCullHits(const uint8_t* hits, uint32_t count, uint32_t* outVisible) {
+  uint32_t visible = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    outVisible[visible] = i;
+    visible += hits[i];
+  }
+  return visible;
+}
+
+// Items are rectangles in SoA arrays. Writes the indices of the ones overlapping view, returns the count.
+static MARK_IGNORE_UNUSED_FUNC uint32_t CullRectsToView(const float* recX, const float* recY, const float* recW, const float* recH, uint32_t count, Rectangle view, MemoryArena* arena, uint32_t** outVisible) {
+  uint32_t* visible = PushArray(arena, count, uint32_t);
+  uint8_t*  hits = PushArray(arena, count, uint8_t);
+  BatchCheckCollisionRecs(recX, recY, recW, recH, count, view, hits);
+  uint32_t visibleCount = CompactCullHits(hits, count, visible);
+  ShrinkLastPush(arena, visible, sizeof(uint32_t) * visibleCount); // Also gives back the hits.
+  *outVisible = visible;
+  return visibleCount;
+}
+
+// Items are centre points reaching at most halfExtent past it. Writes the indices of the ones
+// that can overlap view, returns the count.
+static MARK_IGNORE_UNUSED_FUNC uint32_t CullPointsToView(const float* x, const float* y, uint32_t count, Vector2 halfExtent, Rectangle view, MemoryArena* arena, uint32_t** outVisible) {
+  uint32_t* visible = PushArray(arena, count, uint32_t);
+  uint8_t*  hits = PushArray(arena, count, uint8_t);
+  BatchCheckCollisionPointRec(x, y, count, ExpandRect(view, halfExtent.x, halfExtent.y), hits);
+  uint32_t visibleCount = CompactCullHits(hits, count, visible);
+  ShrinkLastPush(arena, visible, sizeof(uint32_t) * visibleCount);
+  *outVisible = visible;
+  return visibleCount;
+}
+
+// Grid items are culled by their centre, halfExtent is how far their drawn sprite reaches past it.
+// Returns the indices of items that can overlap view, in grid order.
+static MARK_IGNORE_UNUSED_FUNC uint32_t CullGridToView(const SpatialGrid* grid, Vector2 halfExtent, Rectangle view, MemoryArena* arena, uint32_t** outVisible) {
+  return QuerySpatialGridAABB(grid, ExpandRect(view, halfExtent.x, halfExtent.y), arena, outVisible);
+}
+
+#endif // !CULLING_H
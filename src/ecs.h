@@ -0,0 +1,446 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include "game_defines.h"
+#include "mem_arena.h"
+#include "utils.h"
+#include <stdint.h>
+#include <string.h>
+
+// ::ECS
+// Archetype ECS. Entities with the same component set share an archetype, and their components
+// live in 16KB chunks as one array per component, so queries walk matching chunks linearly.
+// Within an archetype only the last chunk is ever partially filled (removal swaps the archetype's
+// last entity into the hole), and empty chunks go back to the world's chunk pool.
+// Structural changes (create/destroy/add/remove) while iterating MUST go through an EcsCommandBuffer.
+#define ECS_CHUNK_SIZE (16 * 1024)
+#define ECS_CHUNK_ALIGNMENT 64
+#define ECS_COMPONENT_ALIGNMENT 16
+#define ECS_MAX_ARCHETYPES 64
+#define ECS_INVALID_ROW UINT32_MAX
+
+// ::COMPONENTS
+typedef Vector2  CompPosition;
+typedef Vector2  CompVelocity;
+typedef SpriteID CompSprite;
+typedef struct CompPlayerControl {
+  int   playerIndex;
+  float moveSpeed;
+} CompPlayerControl;
+typedef struct CompCollider {
+  float radius;
+} CompCollider;
+
+// NOTE: Add new components here. Keep COMP_COUNT <= 32, masks are 32 bit.
+#define ECS_COMPONENT_LIST(X)               \
+  X(COMP_POSITION, CompPosition)            \
+  X(COMP_VELOCITY, CompVelocity)            \
+  X(COMP_SPRITE, CompSprite)                \
+  X(COMP_PLAYER_CONTROL, CompPlayerControl) \
+  X(COMP_COLLIDER, CompCollider)
+
+typedef enum ComponentID {
+#define ECS_COMPONENT_ENUM(id, type) id,
+  ECS_COMPONENT_LIST(ECS_COMPONENT_ENUM)
+#undef ECS_COMPONENT_ENUM
+      COMP_COUNT
+} ComponentID;
+
+static const size_t ECS_COMPONENT_SIZES[COMP_COUNT] = {
+#define ECS_COMPONENT_SIZE(id, type) sizeof(type),
+    ECS_COMPONENT_LIST(ECS_COMPONENT_SIZE)
+#undef ECS_COMPONENT_SIZE
+};
+
+typedef uint32_t ComponentMask;
+#define COMPONENT_BIT(id) (1u << (id))
+
+// ::ECS TYPES
+typedef struct EcsEntity {
+  uint32_t id;
+  uint32_t generation;
+} EcsEntity;
+
+typedef struct EcsArchetype EcsArchetype;
+typedef struct EcsChunk {
+  EcsArchetype*    archetype;
+  struct EcsChunk* prev;
+  struct EcsChunk* next;
+  uint32_t         count;
+} EcsChunk;
+
+struct EcsArchetype {
+  ComponentMask mask;
+  uint32_t      chunkCapacity;
+  uint32_t      entityCount;
+  uint32_t      entitiesOffset;
+  uint32_t      componentOffsets[COMP_COUNT]; // Byte offset from chunk start, 0 if not present.
+  EcsChunk*     firstChunk;
+  EcsChunk*     lastChunk;
+};
+
+typedef struct EcsEntityRecord {
+  EcsChunk* chunk;
+  uint32_t  row;
+  uint32_t  generation;
+} EcsEntityRecord;
+
+typedef struct EcsWorld {
+  MemoryArena* arena;
+
+  EcsArchetype archetypes[ECS_MAX_ARCHETYPES];
+  uint32_t     archetypeCount;
+
+  EcsEntityRecord* records;
+  uint32_t*        freeIds;
+  uint32_t         freeIdCount;
+  uint32_t         maxEntities;
+  uint32_t         entityCount;
+
+  EcsChunk* freeChunks; // Chunk pool, singly linked through next.
+  uint32_t  chunksAllocated;
+} EcsWorld;
+
+// ::ECS WORLD
+static MARK_IGNORE_UNUSED_FUNC EcsWorld* CreateEcsWorld(MemoryArena* arena, uint32_t maxEntities) {
+  EcsWorld* ecs = PushType(arena, EcsWorld);
+  memset(ecs, 0, sizeof(EcsWorld));
+  ecs->arena = arena;
+  ecs->maxEntities = maxEntities;
+  ecs->records = PushArray(arena, maxEntities, EcsEntityRecord);
+  ecs->freeIds = PushArray(arena, maxEntities, uint32_t);
+  ecs->freeIdCount = maxEntities;
+  for (uint32_t i = 0; i < maxEntities; i++) {
+    ecs->records[i] = (EcsEntityRecord){0, ECS_INVALID_ROW, 0};
+    ecs->freeIds[i] = maxEntities - 1 - i;
+  }
+  return ecs;
+}
+
+static MARK_IGNORE_UNUSED_FUNC EcsChunk* EcsAllocChunk(EcsWorld* ecs, EcsArchetype* archetype) {
+  EcsChunk* chunk = ecs->freeChunks;
+  if (chunk) {
+    ecs->freeChunks = chunk->next;
+  } else {
+    chunk = (EcsChunk*)PushSizeAligned_(ecs->arena, ECS_CHUNK_SIZE, ECS_CHUNK_ALIGNMENT);
+    ecs->chunksAllocated++;
+  }
+  chunk->archetype = archetype;
+  chunk->count = 0;
+  chunk->next = 0;
+  chunk->prev = archetype->lastChunk;
+  if (archetype->lastChunk) archetype->lastChunk->next = chunk;
+  else archetype->firstChunk = chunk;
+  archetype->lastChunk = chunk;
+  return chunk;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void EcsFreeLastChunk(EcsWorld* ecs, EcsArchetype* archetype) {
+  EcsChunk* chunk = archetype->lastChunk;
+  archetype->lastChunk = chunk->prev;
+  if (chunk->prev) chunk->prev->next = 0;
+  else archetype->firstChunk = 0;
+  chunk->next = ecs->freeChunks;
+  ecs->freeChunks = chunk;
+}
+
+static MARK_IGNORE_UNUSED_FUNC EcsArchetype* EcsGetArchetype(EcsWorld* ecs, ComponentMask mask) {
+  for (uint32_t i = 0; i < ecs->archetypeCount; i++) {
+    if (ecs->archetypes[i].mask == mask) return &ecs->archetypes[i];
+  }
+
+  assert(ecs->archetypeCount < ECS_MAX_ARCHETYPES && "Too many archetypes, bump ECS_MAX_ARCHETYPES");
+  EcsArchetype* archetype = &ecs->archetypes[ecs->archetypeCount++];
+  memset(archetype, 0, sizeof(EcsArchetype));
+  archetype->mask = mask;
+
+  // Every row costs one EcsEntity plus one of each component, and every array may need alignment padding.
+  size_t headerSize = AlignUp(sizeof(EcsChunk), ECS_COMPONENT_ALIGNMENT);
+  size_t rowSize = sizeof(EcsEntity);
+  size_t padding = ECS_COMPONENT_ALIGNMENT;
+  for (int comp = 0; comp < COMP_COUNT; comp++) {
+    if (!(mask & COMPONENT_BIT(comp))) continue;
+    rowSize += ECS_COMPONENT_SIZES[comp];
+    padding += ECS_COMPONENT_ALIGNMENT;
+  }
+  archetype->chunkCapacity = (uint32_t)((ECS_CHUNK_SIZE - headerSize - padding) / rowSize);
+
+  size_t offset = headerSize;
+  archetype->entitiesOffset = (uint32_t)offset;
+  offset = AlignUp(offset + sizeof(EcsEntity) * archetype->chunkCapacity, ECS_COMPONENT_ALIGNMENT);
+  for (int comp = 0; comp < COMP_COUNT; comp++) {
+    if (!(mask & COMPONENT_BIT(comp))) continue;
+    archetype->componentOffsets[comp] = (uint32_t)offset;
+    offset = AlignUp(offset + ECS_COMPONENT_SIZES[comp] * archetype->chunkCapacity, ECS_COMPONENT_ALIGNMENT);
+  }
+  assert(offset <= ECS_CHUNK_SIZE);
+  return archetype;
+}
+
+// ::ECS CHUNK ACCESS
+static MARK_IGNORE_UNUSED_FUNC EcsEntity* EcsChunkEntities(EcsChunk* chunk) {
+  return (EcsEntity*)((uint8_t*)chunk + chunk->archetype->entitiesOffset);
+}
+#define EcsChunkComponents(chunk, compID, type) ((type*)EcsChunkComponents_(chunk, compID))
+static MARK_IGNORE_UNUSED_FUNC void* EcsChunkComponents_(EcsChunk* chunk, ComponentID comp) {
+  assert((chunk->archetype->mask & COMPONENT_BIT(comp)) && "Chunk does not have component");
+  return (uint8_t*)chunk + chunk->archetype->componentOffsets[comp];
+}
+
+// ::ECS ENTITIES
+static MARK_IGNORE_UNUSED_FUNC bool EcsIsAlive(EcsWorld* ecs, EcsEntity entity) {
+  if (entity.id >= ecs->maxEntities) return false;
+  EcsEntityRecord* record = &ecs->records[entity.id];
+  return record->generation == entity.generation && record->row != ECS_INVALID_ROW;
+}
+
+// Appends a zeroed row to the archetype. Returns the row's chunk and index.
+static MARK_IGNORE_UNUSED_FUNC EcsChunk* EcsAppendRow(EcsWorld* ecs, EcsArchetype* archetype, EcsEntity entity, uint32_t* outRow) {
+  EcsChunk* chunk = archetype->lastChunk;
+  if (!chunk || chunk->count == archetype->chunkCapacity) chunk = EcsAllocChunk(ecs, archetype);
+
+  uint32_t row = chunk->count++;
+  archetype->entityCount++;
+  EcsChunkEntities(chunk)[row] = entity;
+  for (int comp = 0; comp < COMP_COUNT; comp++) {
+    if (!(archetype->mask & COMPONENT_BIT(comp))) continue;
+    memset((uint8_t*)chunk + archetype->componentOffsets[comp] + ECS_COMPONENT_SIZES[comp] * row, 0, ECS_COMPONENT_SIZES[comp]);
+  }
+  *outRow = row;
+  return chunk;
+}
+
+// Fills the hole at (chunk, row) with the archetype's last row to keep chunks dense.
+static MARK_IGNORE_UNUSED_FUNC void EcsRemoveRow(EcsWorld* ecs, EcsChunk* chunk, uint32_t row) {
+  EcsArchetype* archetype = chunk->archetype;
+  EcsChunk*     lastChunk = archetype->lastChunk;
+  uint32_t      lastRow = lastChunk->count - 1;
+
+  if (chunk != lastChunk || row != lastRow) {
+    EcsEntity moved = EcsChunkEntities(lastChunk)[lastRow];
+    EcsChunkEntities(chunk)[row] = moved;
+    for (int comp = 0; comp < COMP_COUNT; comp++) {
+      if (!(archetype->mask & COMPONENT_BIT(comp))) continue;
+      size_t size = ECS_COMPONENT_SIZES[comp];
+      size_t offset = archetype->componentOffsets[comp];
+      memcpy((uint8_t*)chunk + offset + size * row, (uint8_t*)lastChunk + offset + size * lastRow, size);
+    }
+    ecs->records[moved.id].chunk = chunk;
+    ecs->records[moved.id].row = row;
+  }
+
+  lastChunk->count--;
+  archetype->entityCount--;
+  if (lastChunk->count == 0) EcsFreeLastChunk(ecs, archetype);
+}
+
+static MARK_IGNORE_UNUSED_FUNC EcsEntity EcsCreateEntity(EcsWorld* ecs, ComponentMask mask) {
+  assert(ecs->freeIdCount > 0 && "EcsWorld is full");
+  uint32_t  id = ecs->freeIds[--ecs->freeIdCount];
+  EcsEntity entity = {id, ecs->records[id].generation};
+
+  EcsArchetype*    archetype = EcsGetArchetype(ecs, mask);
+  EcsEntityRecord* record = &ecs->records[id];
+  record->chunk = EcsAppendRow(ecs, archetype, entity, &record->row);
+  ecs->entityCount++;
+  return entity;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void EcsDestroyEntity(EcsWorld* ecs, EcsEntity entity) {
+  if (!EcsIsAlive(ecs, entity)) return;
+  EcsEntityRecord* record = &ecs->records[entity.id];
+  EcsRemoveRow(ecs, record->chunk, record->row);
+  record->chunk = 0;
+  record->row = ECS_INVALID_ROW;
+  record->generation++; // Invalidates outstanding handles.
+  ecs->freeIds[ecs->freeIdCount++] = entity.id;
+  ecs->entityCount--;
+}
+
+// Moves the entity to the archetype for newMask, keeping the components both archetypes share.
+static MARK_IGNORE_UNUSED_FUNC void EcsSetEntityMask(EcsWorld* ecs, EcsEntity entity, ComponentMask newMask) {
+  if (!EcsIsAlive(ecs, entity)) return;
+  EcsEntityRecord* record = &ecs->records[entity.id];
+  EcsChunk*        oldChunk = record->chunk;
+  uint32_t         oldRow = record->row;
+  EcsArchetype*    oldArchetype = oldChunk->archetype;
+  if (oldArchetype->mask == newMask) return;
+
+  EcsArchetype* newArchetype = EcsGetArchetype(ecs, newMask);
+  uint32_t      newRow;
+  EcsChunk*     newChunk = EcsAppendRow(ecs, newArchetype, entity, &newRow);
+  ComponentMask shared = oldArchetype->mask & newMask;
+  for (int comp = 0; comp < COMP_COUNT; comp++) {
+    if (!(shared & COMPONENT_BIT(comp))) continue;
+    size_t size = ECS_COMPONENT_SIZES[comp];
+    memcpy((uint8_t*)newChunk + newArchetype->componentOffsets[comp] + size * newRow,
+        (uint8_t*)oldChunk + oldArchetype->componentOffsets[comp] + size * oldRow,
+        size);
+  }
+
+  EcsRemoveRow(ecs, oldChunk, oldRow);
+  record->chunk = newChunk;
+  record->row = newRow;
+}
+
+static MARK_IGNORE_UNUSED_FUNC ComponentMask EcsGetEntityMask(EcsWorld* ecs, EcsEntity entity) {
+  if (!EcsIsAlive(ecs, entity)) return 0;
+  return ecs->records[entity.id].chunk->archetype->mask;
+}
+
+#define EcsGetComponent(ecs, entity, compID, type) ((type*)EcsGetComponent_(ecs, entity, compID))
+static MARK_IGNORE_UNUSED_FUNC void* EcsGetComponent_(EcsWorld* ecs, EcsEntity entity, ComponentID comp) {
+  if (!EcsIsAlive(ecs, entity)) return 0;
+  EcsEntityRecord* record = &ecs->records[entity.id];
+  EcsArchetype*    archetype = record->chunk->archetype;
+  if (!(archetype->mask & COMPONENT_BIT(comp))) return 0;
+  return (uint8_t*)record->chunk + archetype->componentOffsets[comp] + ECS_COMPONENT_SIZES[comp] * record->row;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void EcsSetComponent(EcsWorld* ecs, EcsEntity entity, ComponentID comp, const void* data) {
+  void* dst = EcsGetComponent_(ecs, entity, comp);
+  if (dst) memcpy(dst, data, ECS_COMPONENT_SIZES[comp]);
+}
+
+// ::ECS QUERIES
+// Usage:
+//   EcsQuery query = EcsQueryBegin(ecs, COMPONENT_BIT(COMP_POSITION) | COMPONENT_BIT(COMP_VELOCITY), 0);
+//   while (EcsQueryNext(&query)) {
+//     CompPosition* pos = EcsChunkComponents(query.chunk, COMP_POSITION, CompPosition);
+//     for (uint32_t i = 0; i < query.chunk->count; i++) { ... }
+//   }
+typedef struct EcsQuery {
+  EcsWorld*     ecs;
+  ComponentMask all;
+  ComponentMask none;
+  uint32_t      archetypeIndex;
+  EcsChunk*     chunk;
+} EcsQuery;
+
+static MARK_IGNORE_UNUSED_FUNC EcsQuery EcsQueryBegin(EcsWorld* ecs, ComponentMask all, ComponentMask none) {
+  return (EcsQuery){ecs, all, none, 0, 0};
+}
+
+static MARK_IGNORE_UNUSED_FUNC bool EcsQueryNext(EcsQuery* query) {
+  if (query->chunk && query->chunk->next) {
+    query->chunk = query->chunk->next;
+    return true;
+  }
+  if (query->chunk) query->archetypeIndex++;
+
+  EcsWorld* ecs = query->ecs;
+  for (; query->archetypeIndex < ecs->archetypeCount; query->archetypeIndex++) {
+    EcsArchetype* archetype = &ecs->archetypes[query->archetypeIndex];
+    if ((archetype->mask & query->all) != query->all || (archetype->mask & query->none)) continue;
+    if (!archetype->firstChunk) continue;
+    query->chunk = archetype->firstChunk;
+    return true;
+  }
+  query->chunk = 0;
+  return false;
+}
+
+// ::ECS COMMAND BUFFER
+// Records structural changes during iteration and applies them in order on EcsFlushCommands.
+// Entities created through the buffer are "pending" until flushed, but can already be targeted
+// by later commands in the same buffer.
+#define ECS_PENDING_GENERATION UINT32_MAX
+
+typedef enum EcsCommandType {
+  ECS_CMD_CREATE,
+  ECS_CMD_DESTROY,
+  ECS_CMD_ADD_COMPONENTS,
+  ECS_CMD_REMOVE_COMPONENTS,
+  ECS_CMD_SET_COMPONENT,
+} EcsCommandType;
+
+typedef struct EcsCommand {
+  EcsCommandType type;
+  EcsEntity      entity;
+  ComponentMask  mask;
+  ComponentID    component;
+  uint32_t       dataOffset;
+} EcsCommand;
+
+typedef struct EcsCommandBuffer {
+  EcsCommand* commands;
+  uint32_t    commandCount;
+  uint32_t    maxCommands;
+
+  uint8_t* data; // Component payloads for ECS_CMD_SET_COMPONENT.
+  uint32_t dataUsed;
+  uint32_t dataSize;
+
+  EcsEntity* pendingEntities; // Pending id -> real entity, filled during flush.
+  uint32_t   pendingCount;
+} EcsCommandBuffer;
+
+static MARK_IGNORE_UNUSED_FUNC EcsCommandBuffer* CreateEcsCommandBuffer(MemoryArena* arena, uint32_t maxCommands, uint32_t dataSize) {
+  EcsCommandBuffer* buffer = PushType(arena, EcsCommandBuffer);
+  memset(buffer, 0, sizeof(EcsCommandBuffer));
+  buffer->commands = PushArray(arena, maxCommands, EcsCommand);
+  buffer->maxCommands = maxCommands;
+  buffer->data = (uint8_t*)PushSize(arena, dataSize);
+  buffer->dataSize = dataSize;
+  buffer->pendingEntities = PushArray(arena, maxCommands, EcsEntity);
+  return buffer;
+}
+
+static MARK_IGNORE_UNUSED_FUNC EcsCommand* EcsPushCommand(EcsCommandBuffer* buffer, EcsCommandType type, EcsEntity entity) {
+  assert(buffer->commandCount < buffer->maxCommands && "EcsCommandBuffer is full");
+  EcsCommand* command = &buffer->commands[buffer->commandCount++];
+  memset(command, 0, sizeof(EcsCommand));
+  command->type = type;
+  command->entity = entity;
+  return command;
+}
+
+static MARK_IGNORE_UNUSED_FUNC EcsEntity EcsCmdCreateEntity(EcsCommandBuffer* buffer, ComponentMask mask) {
+  EcsEntity pending = {buffer->pendingCount++, ECS_PENDING_GENERATION};
+  EcsPushCommand(buffer, ECS_CMD_CREATE, pending)->mask = mask;
+  return pending;
+}
+static MARK_IGNORE_UNUSED_FUNC void EcsCmdDestroyEntity(EcsCommandBuffer* buffer, EcsEntity entity) {
+  EcsPushCommand(buffer, ECS_CMD_DESTROY, entity);
+}
+static MARK_IGNORE_UNUSED_FUNC void EcsCmdAddComponents(EcsCommandBuffer* buffer, EcsEntity entity, ComponentMask mask) {
+  EcsPushCommand(buffer, ECS_CMD_ADD_COMPONENTS, entity)->mask = mask;
+}
+static MARK_IGNORE_UNUSED_FUNC void EcsCmdRemoveComponents(EcsCommandBuffer* buffer, EcsEntity entity, ComponentMask mask) {
+  EcsPushCommand(buffer, ECS_CMD_REMOVE_COMPONENTS, entity)->mask = mask;
+}
+static MARK_IGNORE_UNUSED_FUNC void EcsCmdSetComponent(EcsCommandBuffer* buffer, EcsEntity entity, ComponentID comp, const void* data) {
+  uint32_t size = (uint32_t)ECS_COMPONENT_SIZES[comp];
+  uint32_t offset = (uint32_t)AlignUp(buffer->dataUsed, ECS_COMPONENT_ALIGNMENT);
+  assert(offset + size <= buffer->dataSize && "EcsCommandBuffer data is full");
+  memcpy(buffer->data + offset, data, size);
+  buffer->dataUsed = offset + size;
+
+  EcsCommand* command = EcsPushCommand(buffer, ECS_CMD_SET_COMPONENT, entity);
+  command->component = comp;
+  command->dataOffset = offset;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void EcsFlushCommands(EcsWorld* ecs, EcsCommandBuffer* buffer) {
+  for (uint32_t i = 0; i < buffer->commandCount; i++) {
+    EcsCommand* command = &buffer->commands[i];
+    EcsEntity   entity = command->entity;
+    if (entity.generation == ECS_PENDING_GENERATION && command->type != ECS_CMD_CREATE) {
+      entity = buffer->pendingEntities[entity.id];
+    }
+
+    switch (command->type) {
+      case ECS_CMD_CREATE: buffer->pendingEntities[entity.id] = EcsCreateEntity(ecs, command->mask); break;
+      case ECS_CMD_DESTROY: EcsDestroyEntity(ecs, entity); break;
+      case ECS_CMD_ADD_COMPONENTS: EcsSetEntityMask(ecs, entity, EcsGetEntityMask(ecs, entity) | command->mask); break;
+      case ECS_CMD_REMOVE_COMPONENTS: EcsSetEntityMask(ecs, entity, EcsGetEntityMask(ecs, entity) & ~command->mask); break;
+      case ECS_CMD_SET_COMPONENT: EcsSetComponent(ecs, entity, command->component, buffer->data + command->dataOffset); break;
+    }
+  }
+
+  buffer->commandCount = 0;
+  buffer->dataUsed = 0;
+  buffer->pendingCount = 0;
+}
+
+#endif // !ECS_H
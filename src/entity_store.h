@@ -0,0 +1,160 @@
+#ifndef ENTITY_STORE_H
+#define ENTITY_STORE_H
+
+#include "game_defines.h"
+#include "mem_arena.h"
+#include "simd_kernels.h"
+#include "utils.h"
+#include <stdint.h>
+
+// ::ENTITY STORE
+// Struct-of-arrays entity storage. Every component lives in its own dense array so systems
+// stream over contiguous floats (see simd_kernels.h). Removal swaps the last entity into
+// the hole to keep arrays dense, so dense indices are NOT stable across removals.
+// Hold on to an EntityHandle instead and resolve it with GetEntityIndex when needed.
+#define ENTITY_ARRAY_ALIGNMENT 64 // Cache line, also wide enough for AVX loads.
+#define ENTITY_INVALID_INDEX UINT32_MAX
+
+typedef enum EntityFlags {
+  ENTITY_FLAG_NONE = 0,
+  ENTITY_FLAG_VISIBLE = 1 << 0,
+  ENTITY_FLAG_BOUNCE_IN_BOUNDS = 1 << 1,
+
+  // NOTE: Add more flags as needed, keep within 32 bits.
+} EntityFlags;
+
+typedef struct EntityHandle {
+  uint32_t id;
+  uint32_t generation;
+} EntityHandle;
+
+typedef struct EntityStore {
+  uint32_t capacity;
+  uint32_t count;
+
+  // Dense component arrays, indexed [0, count).
+  float*    posX;
+  float*    posY;
+  float*    velX;
+  float*    velY;
+  SpriteID* spriteID;
+  uint32_t* flags;
+  uint32_t* denseToId;
+
+  // Sparse id table, indexed by EntityHandle.id.
+  uint32_t* idToDense;
+  uint32_t* generation;
+  uint32_t* freeIds;
+  uint32_t  freeIdCount;
+} EntityStore;
+
+// Upper bound on arena space CreateEntityStore needs, including alignment padding.
+static MARK_IGNORE_UNUSED_FUNC size_t EntityStoreArenaSize(uint32_t capacity) {
+  size_t perEntity = sizeof(float) * 4 + sizeof(SpriteID) + sizeof(uint32_t) * 5;
+  return AlignUpMaxAlignment(sizeof(EntityStore)) + perEntity * capacity + ENTITY_ARRAY_ALIGNMENT * 10;
+}
+static MARK_IGNORE_UNUSED_FUNC EntityStore* CreateEntityStore(MemoryArena* arena, uint32_t capacity) {
+  EntityStore* store = PushType(arena, EntityStore);
+  store->capacity = capacity;
+  store->count = 0;
+
+  store->posX = PushArrayAligned(arena, capacity, float, ENTITY_ARRAY_ALIGNMENT);
+  store->posY = PushArrayAligned(arena, capacity, float, ENTITY_ARRAY_ALIGNMENT);
+  store->velX = PushArrayAligned(arena, capacity, float, ENTITY_ARRAY_ALIGNMENT);
+  store->velY = PushArrayAligned(arena, capacity, float, ENTITY_ARRAY_ALIGNMENT);
+  store->spriteID = PushArrayAligned(arena, capacity, SpriteID, ENTITY_ARRAY_ALIGNMENT);
+  store->flags = PushArrayAligned(arena, capacity, uint32_t, ENTITY_ARRAY_ALIGNMENT);
+  store->denseToId = PushArray(arena, capacity, uint32_t);
+
+  store->idToDense = PushArray(arena, capacity, uint32_t);
+  store->generation = PushArray(arena, capacity, uint32_t);
+  store->freeIds = PushArray(arena, capacity, uint32_t);
+
+  // Hand out low ids first so small scenes touch little of the sparse table.
+  store->freeIdCount = capacity;
+  for (uint32_t i = 0; i < capacity; i++) {
+    store->freeIds[i] = capacity - 1 - i;
+    store->idToDense[i] = ENTITY_INVALID_INDEX;
+    store->generation[i] = 0;
+  }
+  return store;
+}
+
+static MARK_IGNORE_UNUSED_FUNC EntityHandle SpawnEntity(EntityStore* store, Vector2 pos, Vector2 vel, SpriteID spriteID, uint32_t flags) {
+  assert(store->freeIdCount > 0 && "EntityStore is full");
+  uint32_t id = store->freeIds[--store->freeIdCount];
+  uint32_t index = store->count++;
+
+  store->posX[index] = pos.x;
+  store->posY[index] = pos.y;
+  store->velX[index] = vel.x;
+  store->velY[index] = vel.y;
+  store->spriteID[index] = spriteID;
+  store->flags[index] = flags;
+  store->denseToId[index] = id;
+  store->idToDense[id] = index;
+
+  return (EntityHandle){id, store->generation[id]};
+}
+
+static MARK_IGNORE_UNUSED_FUNC uint32_t GetEntityIndex(EntityStore* store, EntityHandle handle) {
+  if (handle.id >= store->capacity || store->generation[handle.id] != handle.generation) return ENTITY_INVALID_INDEX;
+  return store->idToDense[handle.id];
+}
+
+static MARK_IGNORE_UNUSED_FUNC bool IsEntityAlive(EntityStore* store, EntityHandle handle) {
+  return GetEntityIndex(store, handle) != ENTITY_INVALID_INDEX;
+}
+
+// Swap-remove: the last entity moves into the removed slot.
+static MARK_IGNORE_UNUSED_FUNC void DestroyEntity(EntityStore* store, EntityHandle handle) {
+  uint32_t index = GetEntityIndex(store, handle);
+  if (index == ENTITY_INVALID_INDEX) return;
+
+  uint32_t last = --store->count;
+  if (index != last) {
+    store->posX[index] = store->posX[last];
+    store->posY[index] = store->posY[last];
+    store->velX[index] = store->velX[last];
+    store->velY[index] = store->velY[last];
+    store->spriteID[index] = store->spriteID[last];
+    store->flags[index] = store->flags[last];
+    store->denseToId[index] = store->denseToId[last];
+    store->idToDense[store->denseToId[index]] = index;
+  }
+
+  store->idToDense[handle.id] = ENTITY_INVALID_INDEX;
+  store->generation[handle.id]++; // Invalidates outstanding handles.
+  store->freeIds[store->freeIdCount++] = handle.id;
+}
+
+static MARK_IGNORE_UNUSED_FUNC Vector2 GetEntityPos(EntityStore* store, uint32_t index) {
+  return (Vector2){store->posX[index], store->posY[index]};
+}
+
+// ::ENTITY SYSTEMS
+// Systems take a [start, end) range of dense indices so they can be split across job workers.
+static MARK_IGNORE_UNUSED_FUNC void IntegrateEntityVelocities(EntityStore* store, uint32_t start, uint32_t end, float deltaTime) {
+  SimdIntegrate(store->posX + start, store->velX + start, end - start, deltaTime);
+  SimdIntegrate(store->posY + start, store->velY + start, end - start, deltaTime);
+}
+
+// Reflects velocity of ENTITY_FLAG_BOUNCE_IN_BOUNDS entities that left bounds.
+static MARK_IGNORE_UNUSED_FUNC void BounceEntitiesInBounds(EntityStore* store, uint32_t start, uint32_t end, Rectangle bounds) {
+  const float* restrict    posX = store->posX;
+  const float* restrict    posY = store->posY;
+  float* restrict          velX = store->velX;
+  float* restrict          velY = store->velY;
+  const uint32_t* restrict flags = store->flags;
+  float                    minX = bounds.x, maxX = bounds.x + bounds.width;
+  float                    minY = bounds.y, maxY = bounds.y + bounds.height;
+  for (uint32_t i = start; i < end; i++) {
+    bool  bounce = (flags[i] & ENTITY_FLAG_BOUNCE_IN_BOUNDS) != 0;
+    float flipX = (bounce && (posX[i] < minX || posX[i] > maxX)) ? -1.0f : 1.0f;
+    float flipY = (bounce && (posY[i] < minY || posY[i] > maxY)) ? -1.0f : 1.0f;
+    velX[i] *= flipX;
+    velY[i] *= flipY;
+  }
+}
+
+#endif // !ENTITY_STORE_H
@@ -0,0 +1,70 @@
+#ifndef FILE_MAP_H
+#define FILE_MAP_H
+
+#include "include/raylib.h"
+#include "utils.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ::FILE MAP
+// Read only view of a whole file. On POSIX it's an mmap, so opening costs no reads and pages
+// come in on first touch. Win32 falls back to LoadFileData: windows.h clashes with raylib's names.
+typedef struct MappedFile {
+  const void* data; // NULL if the file couldn't be opened.
+  size_t      size;
+  bool        borrowed; // data belongs to someone else (e.g. embedded resources), UnmapFile leaves it.
+  bool        heap;     // data was MemAlloc'd (e.g. a decompressed pack entry), UnmapFile frees it.
+} MappedFile;
+
+static MARK_IGNORE_UNUSED_FUNC MappedFile MapFile(const char* path) {
+  MappedFile file = {0};
+#ifndef _WIN32
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    TraceLog(LOG_ERROR, "FILEMAP: Failed to open %s", path);
+    return file;
+  }
+  struct stat info;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      file.data = data;
+      file.size = (size_t)info.st_size;
+    }
+  }
+  close(fd); // The mapping keeps the file alive.
+  if (!file.data) TraceLog(LOG_ERROR, "FILEMAP: Failed to map %s", path);
+#else
+  int size = 0;
+  file.data = LoadFileData(path, &size);
+  file.size = file.data ? (size_t)size : 0;
+#endif
+  return file;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void UnmapFile(MappedFile* file) {
+  if (!file->data || file->borrowed) {
+    *file = (MappedFile){0};
+    return;
+  }
+  if (file->heap) {
+    MemFree((void*)file->data);
+    *file = (MappedFile){0};
+    return;
+  }
+#ifndef _WIN32
+  munmap((void*)file->data, file->size);
+#else
+  UnloadFileData((unsigned char*)file->data);
+#endif
+  *file = (MappedFile){0};
+}
+
+#endif // !FILE_MAP_H
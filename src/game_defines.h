@@ -3,6 +3,8 @@
 
 #include "include/raylib.h"
 #include "include/raymath.h"
+#include "build_defines.h"
+#include "generated/atlas_sprites.h"
 
 // ::SYSTEM
 #ifdef _WIN32
@@ -19,7 +21,12 @@ typedef enum TextureID {
   TEX_NIL = 0,
 
   TEX_RAYLIB_LOGO,
-  TEX_MAIN,
+  TEX_FONT_DEFAULT, // raylib's default font, owned by raylib. For cached text, see text_cache.h.
+
+  // One per atlas in build_defines.h's ATLAS_MANIFEST, e.g. TEX_MAIN.
+#define X(ID, sourceFolder, fileName, size, maxSprites) TEX_##ID,
+  ATLAS_MANIFEST(X)
+#undef X
 
   TEX_COUNT
 } TextureID;
@@ -27,9 +34,12 @@ typedef enum SpriteID {
   SPRITE_NIL = 0,
   SPRITE_RAYLIB_LOGO,
 
-  // MAIN TEXTURE
-  SPRITE_MAIN_PLAYER_1,
-  SPRITE_MAIN_PLAYER_2,
+  // Every atlas's sprites, generated by the sprite packer from its folder in resources/.
+#define X(id, name, x, y, width, height) id,
+#define ATLAS_SPRITE_IDS(ID, sourceFolder, fileName, size, maxSprites) ID##_ATLAS_SPRITES(X)
+  ATLAS_MANIFEST(ATLAS_SPRITE_IDS)
+#undef ATLAS_SPRITE_IDS
+#undef X
 
   SPRITE_COUNT
 } SpriteID;
@@ -40,11 +50,11 @@ typedef struct SpriteData {
 } SpriteData;
 
 // ::WORLD
+typedef struct EcsWorld EcsWorld; // See ecs.h
 typedef struct {
   Camera2D camera;
 
-  Vector2 player1Pos;
-  Vector2 player2Pos;
+  EcsWorld* ecs;
 } World;
 
 // ::GLOBALS
@@ -0,0 +1,7 @@
+// Generated by nob's sprite packer from src/build_defines.h's ATLAS_MANIFEST, don't edit.
+#ifndef ATLAS_SPRITES_H
+#define ATLAS_SPRITES_H
+
+#include "main_atlas_sprites.h"
+
+#endif // !ATLAS_SPRITES_H
@@ -0,0 +1,10 @@
+// Generated by nob's sprite packer from resources/mainAtlas, don't edit.
+// X(id, name, x, y, width, height) for each sprite in the atlas.
+#ifndef MAIN_ATLAS_SPRITES_H
+#define MAIN_ATLAS_SPRITES_H
+
+#define MAIN_ATLAS_SPRITES(X) \
+  X(SPRITE_MAIN_PLAYER_1, "player_1", 0, 0, 128, 128) \
+  X(SPRITE_MAIN_PLAYER_2, "player_2", 128, 0, 128, 128)
+
+#endif // !MAIN_ATLAS_SPRITES_H
@@ -0,0 +1,367 @@
+#ifndef HOT_RELOAD_H
+#define HOT_RELOAD_H
+
+#include "include/raylib.h"
+#include "asset_loader.h"
+#include "atlas_format.h"
+#include "game_defines.h"
+#include "mem_arena.h"
+#include "texture_packer_utils.h"
+#include "utils.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// ::HOT RELOAD
+// Debug builds watch each atlas's source folder and packer outputs in the project's resources/
+// (the executable's parent folder, bin/..) from a background thread:
+// - A changed source image reruns `nob spritepack`, which only repacks atlases whose sources
+//   hash differently.
+// - Changed outputs (a packer run from outside, or the one above) are copied next to the
+//   executable, where the game loads resources from.
+// UpdateHotReload then queues the atlas on the asset loader at a frame boundary, with rects
+// looked up by name in the new metadata. The loader swaps texture and sprites[] rects together
+// once the upload is done, so there's never a frame with one and not the other.
+// Sprites added or removed need a rebuild: their ids come from the generated header.
+// Linux is woken by inotify, other platforms compare file times every HOT_RELOAD_POLL_MS.
+#define HOT_RELOAD_MAX_ATLASES 64
+#define HOT_RELOAD_POLL_MS 500
+#define HOT_RELOAD_SETTLE_MS 250 // Editors save in bursts, wait this long without changes before packing.
+
+typedef struct HotReloadAtlas {
+  TextureID          texture;
+  const char*        sourceFolder; // In resources/, as in ATLAS_MANIFEST.
+  const char*        imageFile;
+  const char*        textureFile;
+  const char*        metaFile;
+  const AtlasSprite* table;   // Compiled in, names are looked up in the new metadata.
+  AtlasSprite*       sprites; // table with the latest rects, handed to the asset loader.
+  int                count;
+
+  // Watcher thread.
+  int      sourceWatch; // inotify watch descriptor.
+  uint64_t sourceStamp; // Polling only.
+  uint64_t outputStamp;
+  bool     sourceChanged;
+  bool     outputChanged;
+
+  atomic_int pending; // New outputs are next to the executable, waiting for UpdateHotReload.
+} HotReloadAtlas;
+
+typedef struct HotReload {
+  HotReloadAtlas atlases[HOT_RELOAD_MAX_ATLASES];
+  int            atlasCount;
+  char           projectRoot[MAX_PATH_LENGTH - 64]; // Leaves room for resources/<file> in a MAX_PATH_LENGTH path.
+
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  stop; // Wakes a polling sleep on shutdown.
+  bool            running; // Guarded by mutex.
+  int             inotifyFd; // -1 when polling.
+  int             resourcesWatch;
+} HotReload;
+
+// False if the path didn't fit.
+static MARK_IGNORE_UNUSED_FUNC bool BuildProjectResourcePath(HotReload* reload, const char* fileName, char* outPath) {
+  return snprintf(outPath, MAX_PATH_LENGTH, "%sresources%c%s", reload->projectRoot, PATH_SEPARATOR, fileName) < MAX_PATH_LENGTH;
+}
+
+// ::HOT RELOAD WATCHER
+// Changes to a folder's files or a list of files, as a hash of names, sizes and write times.
+// NOTE: Write times are in seconds, two same size saves within one second look the same when polling.
+static MARK_IGNORE_UNUSED_FUNC uint64_t HashFileStamp(uint64_t hash, const char* path) {
+  long     modTime = GetFileModTime(path);
+  int      length = GetFileLength(path);
+  uint64_t values[2] = {(uint64_t)modTime, (uint64_t)length};
+  for (const char* c = path; *c; c++) hash = (hash ^ (uint8_t)*c) * 0x100000001B3ull; // FNV-1a
+  for (size_t i = 0; i < sizeof(values); i++) hash = (hash ^ ((uint8_t*)values)[i]) * 0x100000001B3ull;
+  return hash;
+}
+
+static MARK_IGNORE_UNUSED_FUNC uint64_t GetAtlasSourceStamp(HotReload* reload, HotReloadAtlas* atlas) {
+  char folder[MAX_PATH_LENGTH];
+  BuildProjectResourcePath(reload, atlas->sourceFolder, folder);
+  FilePathList files = LoadDirectoryFiles(folder);
+  uint64_t     hash = 0xCBF29CE484222325ull;
+  for (unsigned int i = 0; i < files.count; i++) hash = HashFileStamp(hash, files.paths[i]);
+  UnloadDirectoryFiles(files);
+  return hash;
+}
+
+static MARK_IGNORE_UNUSED_FUNC uint64_t GetAtlasOutputStamp(HotReload* reload, HotReloadAtlas* atlas) {
+  const char* outputs[] = {atlas->imageFile, atlas->textureFile, atlas->metaFile};
+  uint64_t    hash = 0xCBF29CE484222325ull;
+  for (size_t i = 0; i < sizeof(outputs) / sizeof(outputs[0]); i++) {
+    char path[MAX_PATH_LENGTH];
+    BuildProjectResourcePath(reload, outputs[i], path);
+    hash = HashFileStamp(hash, path);
+  }
+  return hash;
+}
+
+static MARK_IGNORE_UNUSED_FUNC bool IsHotReloadRunning(HotReload* reload) {
+  pthread_mutex_lock(&reload->mutex);
+  bool running = reload->running;
+  pthread_mutex_unlock(&reload->mutex);
+  return running;
+}
+
+// Sleeps up to ms, returns early once stopped.
+static MARK_IGNORE_UNUSED_FUNC void SleepHotReload(HotReload* reload, int ms) {
+  struct timespec wakeTime;
+  clock_gettime(CLOCK_REALTIME, &wakeTime);
+  wakeTime.tv_sec += ms / 1000;
+  wakeTime.tv_nsec += (long)(ms % 1000) * 1000000L;
+  if (wakeTime.tv_nsec >= 1000000000L) {
+    wakeTime.tv_sec++;
+    wakeTime.tv_nsec -= 1000000000L;
+  }
+  pthread_mutex_lock(&reload->mutex);
+  if (reload->running) pthread_cond_timedwait(&reload->stop, &reload->mutex, &wakeTime);
+  pthread_mutex_unlock(&reload->mutex);
+}
+
+#ifdef __linux__
+static MARK_IGNORE_UNUSED_FUNC int64_t GetHotReloadClockMs(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+#endif
+
+// Sets the atlases' changed flags from whatever happened in the next ms. Returns true as soon as
+// anything did, false once ms passed quietly (or it was stopped).
+static MARK_IGNORE_UNUSED_FUNC bool CheckHotReloadChanges(HotReload* reload, int ms) {
+  bool changed = false;
+#ifdef __linux__
+  if (reload->inotifyFd >= 0) {
+    struct pollfd pollFd = {reload->inotifyFd, POLLIN, 0};
+    int64_t       deadline = GetHotReloadClockMs() + ms;
+    for (;;) { // Polls in short slices, so stopping isn't held up.
+      int64_t left = deadline - GetHotReloadClockMs();
+      if (left <= 0 || !IsHotReloadRunning(reload)) return false;
+      if (poll(&pollFd, 1, left < 100 ? (int)left : 100) > 0) break;
+    }
+    _Alignas(struct inotify_event) char buffer[4096];
+    ssize_t size;
+    while ((size = read(reload->inotifyFd, buffer, sizeof(buffer))) > 0) {
+      for (char* at = buffer; at < buffer + size;) {
+        struct inotify_event* event = (struct inotify_event*)at;
+        at += sizeof(struct inotify_event) + event->len;
+        for (int i = 0; i < reload->atlasCount; i++) {
+          HotReloadAtlas* atlas = &reload->atlases[i];
+          bool            isSource = event->wd == atlas->sourceWatch;
+          bool            isOutput = event->wd == reload->resourcesWatch && event->len > 0 &&
+                          (strcmp(event->name, atlas->imageFile) == 0 || strcmp(event->name, atlas->textureFile) == 0 || strcmp(event->name, atlas->metaFile) == 0);
+          atlas->sourceChanged |= isSource;
+          atlas->outputChanged |= isOutput;
+          changed |= isSource || isOutput;
+        }
+      }
+    }
+    return changed;
+  }
+#endif
+  SleepHotReload(reload, ms);
+  for (int i = 0; i < reload->atlasCount; i++) {
+    HotReloadAtlas* atlas = &reload->atlases[i];
+    uint64_t        sourceStamp = GetAtlasSourceStamp(reload, atlas);
+    uint64_t        outputStamp = GetAtlasOutputStamp(reload, atlas);
+    atlas->sourceChanged |= sourceStamp != atlas->sourceStamp;
+    atlas->outputChanged |= outputStamp != atlas->outputStamp;
+    changed |= sourceStamp != atlas->sourceStamp || outputStamp != atlas->outputStamp;
+    atlas->sourceStamp = sourceStamp;
+    atlas->outputStamp = outputStamp;
+  }
+  return changed;
+}
+
+// Forgets changes made by our own packer run.
+static MARK_IGNORE_UNUSED_FUNC void IgnoreHotReloadChanges(HotReload* reload) {
+#ifdef __linux__
+  if (reload->inotifyFd >= 0) {
+    char buffer[4096];
+    while (read(reload->inotifyFd, buffer, sizeof(buffer)) > 0) {}
+  }
+#endif
+  for (int i = 0; i < reload->atlasCount; i++) {
+    HotReloadAtlas* atlas = &reload->atlases[i];
+    if (reload->inotifyFd < 0) {
+      atlas->sourceStamp = GetAtlasSourceStamp(reload, atlas);
+      atlas->outputStamp = GetAtlasOutputStamp(reload, atlas);
+    }
+    atlas->sourceChanged = false;
+    atlas->outputChanged = false;
+  }
+}
+
+// Blocks until something changed and then stayed quiet for HOT_RELOAD_SETTLE_MS. False once stopped.
+static MARK_IGNORE_UNUSED_FUNC bool WaitForHotReloadChanges(HotReload* reload) {
+  bool changed = false;
+  while (IsHotReloadRunning(reload)) {
+    if (CheckHotReloadChanges(reload, changed ? HOT_RELOAD_SETTLE_MS : HOT_RELOAD_POLL_MS)) changed = true;
+    else if (changed) return true;
+  }
+  return false;
+}
+
+static MARK_IGNORE_UNUSED_FUNC bool RunSpritePacker(HotReload* reload) {
+  char command[MAX_PATH_LENGTH + 64];
+#ifdef _WIN32
+  snprintf(command, sizeof(command), "cd /d \"%s\" && nob.exe spritepack", reload->projectRoot);
+#else
+  snprintf(command, sizeof(command), "cd \"%s\" && ./nob spritepack", reload->projectRoot);
+#endif
+  TraceLog(LOG_INFO, "HOTRELOAD: Running %s", command);
+  return system(command) == 0;
+}
+
+// Copies through a temporary file, so nothing ever loads a half written output.
+static MARK_IGNORE_UNUSED_FUNC bool CopyAtlasOutputs(HotReload* reload, HotReloadAtlas* atlas) {
+  const char* outputs[] = {atlas->imageFile, atlas->textureFile, atlas->metaFile};
+  for (size_t i = 0; i < sizeof(outputs) / sizeof(outputs[0]); i++) {
+    char source[MAX_PATH_LENGTH];
+    char destination[MAX_PATH_LENGTH];
+    char temporary[MAX_PATH_LENGTH];
+    BuildResourcePath(outputs[i], destination);
+    if (!BuildProjectResourcePath(reload, outputs[i], source) || snprintf(temporary, sizeof(temporary), "%s.reload", destination) >= (int)sizeof(temporary)) return false;
+
+    int            size = 0;
+    unsigned char* data = LoadFileData(source, &size);
+    bool           saved = data && SaveFileData(temporary, data, size);
+    UnloadFileData(data);
+#ifdef _WIN32
+    if (saved) remove(destination); // rename doesn't replace on Windows.
+#endif
+    if (!saved || rename(temporary, destination) != 0) {
+      TraceLog(LOG_WARNING, "HOTRELOAD: Failed to copy %s", source);
+      return false;
+    }
+  }
+  return true;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void* HotReloadThreadMain(void* param) {
+  HotReload* reload = (HotReload*)param;
+  while (WaitForHotReloadChanges(reload)) {
+    bool pack = false;
+    for (int i = 0; i < reload->atlasCount; i++) pack |= reload->atlases[i].sourceChanged;
+    bool packed = !pack || RunSpritePacker(reload);
+    if (!packed) TraceLog(LOG_WARNING, "HOTRELOAD: Sprite packer failed, keeping the current atlases");
+
+    for (int i = 0; i < reload->atlasCount && packed; i++) {
+      HotReloadAtlas* atlas = &reload->atlases[i];
+      if (!atlas->sourceChanged && !atlas->outputChanged) continue;
+      if (CopyAtlasOutputs(reload, atlas)) atomic_store_explicit(&atlas->pending, 1, memory_order_release);
+    }
+    IgnoreHotReloadChanges(reload);
+  }
+  return 0;
+}
+
+// ::HOT RELOAD API
+static MARK_IGNORE_UNUSED_FUNC HotReload* CreateHotReload(MemoryArena* arena) {
+  HotReload* reload = PushType(arena, HotReload);
+  memset(reload, 0, sizeof(HotReload));
+  snprintf(reload->projectRoot, sizeof(reload->projectRoot), "%s..%c", GetApplicationDirectory(), PATH_SEPARATOR);
+  reload->inotifyFd = -1;
+  reload->resourcesWatch = -1;
+  pthread_mutex_init(&reload->mutex, 0);
+  pthread_cond_init(&reload->stop, 0);
+  return reload;
+}
+
+// Before StartHotReload. Names come from the atlas's metadata file, table from its generated header.
+static MARK_IGNORE_UNUSED_FUNC void AddHotReloadAtlas(HotReload* reload, MemoryArena* arena, TextureID texture, const char* sourceFolder, const char* imageFile, const char* textureFile, const char* metaFile, const AtlasSprite* table, int count) {
+  if (reload->atlasCount >= HOT_RELOAD_MAX_ATLASES) {
+    TraceLog(LOG_WARNING, "HOTRELOAD: Too many atlases, %s isn't watched", sourceFolder);
+    return;
+  }
+  HotReloadAtlas* atlas = &reload->atlases[reload->atlasCount++];
+  *atlas = (HotReloadAtlas){
+      .texture = texture,
+      .sourceFolder = sourceFolder,
+      .imageFile = imageFile,
+      .textureFile = textureFile,
+      .metaFile = metaFile,
+      .table = table,
+      .sprites = PushArray(arena, count, AtlasSprite),
+      .count = count,
+      .sourceWatch = -1,
+  };
+  memcpy(atlas->sprites, table, sizeof(AtlasSprite) * count);
+  atlas->sourceStamp = GetAtlasSourceStamp(reload, atlas);
+  atlas->outputStamp = GetAtlasOutputStamp(reload, atlas);
+}
+
+static MARK_IGNORE_UNUSED_FUNC void StartHotReload(HotReload* reload) {
+#ifdef __linux__
+  reload->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (reload->inotifyFd >= 0) {
+    char path[MAX_PATH_LENGTH];
+    BuildProjectResourcePath(reload, "", path);
+    reload->resourcesWatch = inotify_add_watch(reload->inotifyFd, path, IN_CLOSE_WRITE | IN_MOVED_TO);
+    for (int i = 0; i < reload->atlasCount; i++) {
+      BuildProjectResourcePath(reload, reload->atlases[i].sourceFolder, path);
+      reload->atlases[i].sourceWatch = inotify_add_watch(reload->inotifyFd, path, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE);
+    }
+  }
+  if (reload->resourcesWatch < 0 && reload->inotifyFd >= 0) {
+    close(reload->inotifyFd); // Nothing to be woken by, poll instead.
+    reload->inotifyFd = -1;
+  }
+#endif
+  TraceLog(LOG_INFO, "HOTRELOAD: Watching %sresources (%s)", reload->projectRoot, reload->inotifyFd >= 0 ? "inotify" : "polling");
+  reload->running = true;
+  pthread_create(&reload->thread, 0, HotReloadThreadMain, reload);
+}
+
+// Main thread, at a frame boundary. Queues atlases whose new outputs are in.
+// NOTE: A reload still uploading when the next one is queued takes the newer rects with it,
+// the newer texture replaces it right after.
+static MARK_IGNORE_UNUSED_FUNC void UpdateHotReload(HotReload* reload, AssetLoader* loader) {
+  for (int i = 0; i < reload->atlasCount; i++) {
+    HotReloadAtlas* atlas = &reload->atlases[i];
+    if (!atomic_exchange_explicit(&atlas->pending, 0, memory_order_acquire)) continue;
+
+    MappedFile             metaFile;
+    const AtlasMetaHeader* meta = LoadAtlasMeta(atlas->metaFile, &metaFile);
+    if (!meta) continue;
+    for (int j = 0; j < atlas->count; j++) {
+      const AtlasMetaRect* rect = FindAtlasMetaRect(meta, atlas->table[j].name);
+      if (rect) atlas->sprites[j].rect = (Rectangle){rect->x, rect->y, rect->width, rect->height};
+      else TraceLog(LOG_WARNING, "HOTRELOAD: Sprite %s was removed, rebuild to drop it", atlas->table[j].name);
+    }
+    if ((int)meta->spriteCount > atlas->count) TraceLog(LOG_WARNING, "HOTRELOAD: %s has new sprites, rebuild to use them", atlas->sourceFolder);
+    UnmapFile(&metaFile);
+
+    TraceLog(LOG_INFO, "HOTRELOAD: Reloading %s", atlas->sourceFolder);
+    RequestTextureLoad(loader, atlas->texture, atlas->textureFile, atlas->imageFile, atlas->sprites, atlas->count, SPRITE_NIL);
+  }
+}
+
+static MARK_IGNORE_UNUSED_FUNC void DestroyHotReload(HotReload* reload) {
+  pthread_mutex_lock(&reload->mutex);
+  bool running = reload->running;
+  reload->running = false;
+  pthread_cond_broadcast(&reload->stop);
+  pthread_mutex_unlock(&reload->mutex);
+  if (running) pthread_join(reload->thread, 0);
+#ifdef __linux__
+  if (reload->inotifyFd >= 0) close(reload->inotifyFd);
+#endif
+  pthread_cond_destroy(&reload->stop);
+  pthread_mutex_destroy(&reload->mutex);
+}
+
+#endif // !HOT_RELOAD_H
@@ -12,6 +12,7 @@ typedef enum ConsumableInputType {
   INPUT_ENTER_PRESSED,
   INPUT_Y_PRESSED,
   INPUT_N_PRESSED,
+  INPUT_F3_PRESSED,
 
   INPUT_UP_DOWN,
   INPUT_DOWN_DOWN,
@@ -56,6 +57,7 @@ void pollInputs() {
   registerInputState(INPUT_ENTER_PRESSED, IsKeyPressed(KEY_ENTER));
   registerInputState(INPUT_Y_PRESSED, IsKeyPressed(KEY_Y));
   registerInputState(INPUT_N_PRESSED, IsKeyPressed(KEY_N));
+  registerInputState(INPUT_F3_PRESSED, IsKeyPressed(KEY_F3));
 
   registerInputState(INPUT_UP_DOWN, IsKeyDown(KEY_UP));
   registerInputState(INPUT_DOWN_DOWN, IsKeyDown(KEY_DOWN));
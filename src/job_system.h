@@ -0,0 +1,349 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include "mem_arena.h"
+#include "utils.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <unistd.h> // For sysconf
+#endif
+
+// ::JOB SYSTEM
+// One worker per core, each with a Chase-Lev work-stealing deque. Thread 0 is the main thread,
+// it only runs jobs while it waits on a counter. Workers pop their own deque LIFO (hot caches)
+// and steal FIFO from others when empty.
+// Every thread has a scratch arena; a job's scratch allocations are released when it returns.
+// NOTE: Windows builds need winpthreads, nob links -lpthread.
+#define JOB_MAX_THREADS 64
+#define JOB_DEQUE_SIZE 1024 // Power of 2. Max jobs queued per thread.
+#define JOB_POOL_SIZE 1024  // Power of 2. Job structs per thread, reused once they have run.
+#define JOB_IDLE_SPINS 64   // Failed steal attempts before a worker goes to sleep.
+#define JOB_SLEEP_TIMEOUT_NS 1000000
+
+typedef struct JobCounter {
+  atomic_int pending;
+} JobCounter;
+
+typedef void (*JobFunc)(void* data, MemoryArena* scratch);
+
+typedef struct ParallelForData ParallelForData;
+typedef struct Job {
+  JobFunc     func;
+  void*       data;
+  JobCounter* counter;
+
+  // Set for ParallelFor jobs instead of func/data, see RunParallelForRange.
+  ParallelForData* parallelFor;
+  uint32_t         start;
+  uint32_t         end;
+
+  atomic_int inUse; // Queued or running. Cleared by RunJob on whichever thread ran it.
+} Job;
+
+typedef struct JobDeque {
+  _Atomic int64_t top; // 64 bit on every target, both only ever grow. long is 32 bit on Windows.
+  char            pad0[64 - sizeof(_Atomic int64_t)]; // Keep thieves and owner off each other's cache line.
+  _Atomic int64_t bottom;
+  char            pad1[64 - sizeof(_Atomic int64_t)];
+  Job* _Atomic    buffer[JOB_DEQUE_SIZE];
+} JobDeque;
+
+typedef struct JobSystem JobSystem;
+typedef struct JobWorker {
+  JobSystem*   system;
+  int          index;
+  pthread_t    thread;
+  JobDeque     deque;
+  Job          pool[JOB_POOL_SIZE];
+  uint32_t     poolNext;
+  MemoryArena* scratch;
+  uint32_t     rng;
+} JobWorker;
+
+struct JobSystem {
+  int        threadCount;
+  JobWorker* workers;
+  atomic_int running;
+
+  pthread_mutex_t sleepMutex;
+  pthread_cond_t  sleepCond;
+  atomic_int      sleepers;
+};
+
+static _Thread_local int jobThreadIndex = 0; // 0 for the main thread and any non-worker thread.
+
+static MARK_IGNORE_UNUSED_FUNC int GetCoreCount() {
+#ifdef _WIN32
+  int count = pthread_num_processors_np();
+#else
+  int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if (count < 1) count = 1;
+  if (count > JOB_MAX_THREADS) count = JOB_MAX_THREADS;
+  return count;
+}
+
+// ::JOB DEQUE
+// Chase-Lev deque, as in "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013).
+static MARK_IGNORE_UNUSED_FUNC bool JobDequePush(JobDeque* deque, Job* job) {
+  int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+  int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+  if (bottom - top >= JOB_DEQUE_SIZE) return false;
+  atomic_store_explicit(&deque->buffer[bottom & (JOB_DEQUE_SIZE - 1)], job, memory_order_relaxed);
+  atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release); // Publishes the job to thieves.
+  return true;
+}
+
+// Owner only.
+static MARK_IGNORE_UNUSED_FUNC Job* JobDequePop(JobDeque* deque) {
+  int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+  atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+  Job* job = 0;
+  if (top <= bottom) {
+    job = atomic_load_explicit(&deque->buffer[bottom & (JOB_DEQUE_SIZE - 1)], memory_order_relaxed);
+    if (top == bottom) { // Last job, race any thieves for it.
+      if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) job = 0;
+      atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+  } else {
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+  }
+  return job;
+}
+
+// Any thread.
+static MARK_IGNORE_UNUSED_FUNC Job* JobDequeSteal(JobDeque* deque) {
+  int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+  if (top >= bottom) return 0;
+
+  Job* job = atomic_load_explicit(&deque->buffer[top & (JOB_DEQUE_SIZE - 1)], memory_order_relaxed);
+  if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) return 0;
+  return job;
+}
+
+// ::JOB EXECUTION
+static MARK_IGNORE_UNUSED_FUNC JobWorker* GetCurrentJobWorker(JobSystem* system) {
+  return &system->workers[jobThreadIndex];
+}
+
+static MARK_IGNORE_UNUSED_FUNC MemoryArena* GetJobScratchArena(JobSystem* system) {
+  return GetCurrentJobWorker(system)->scratch;
+}
+
+static void RunParallelForRange(JobWorker* worker, ParallelForData* pfor, uint32_t start, uint32_t end);
+static MARK_IGNORE_UNUSED_FUNC void RunJob(JobWorker* worker, Job* job) {
+  TempMemory scratchMemory = BeginTempMemory(worker->scratch); // Nesting safe, waits can run jobs inside jobs.
+  if (job->parallelFor) RunParallelForRange(worker, job->parallelFor, job->start, job->end);
+  else job->func(job->data, worker->scratch);
+  EndTempMemory(scratchMemory);
+  JobCounter* counter = job->counter;
+  atomic_store_explicit(&job->inUse, 0, memory_order_release); // The owner may hand it out again from here on.
+  if (counter) atomic_fetch_sub_explicit(&counter->pending, 1, memory_order_release);
+}
+
+static MARK_IGNORE_UNUSED_FUNC Job* FindJob(JobWorker* worker) {
+  Job* job = JobDequePop(&worker->deque);
+  if (job) return job;
+
+  JobSystem* system = worker->system;
+  int        threadCount = system->threadCount;
+  for (int attempt = 0; attempt < threadCount; attempt++) {
+    worker->rng = worker->rng * 1664525u + 1013904223u;
+    int victim = (int)(worker->rng >> 16) % threadCount;
+    if (victim == worker->index) continue;
+    job = JobDequeSteal(&system->workers[victim].deque);
+    if (job) return job;
+  }
+  return 0;
+}
+
+// Runs one queued job on the calling thread if there is one.
+static MARK_IGNORE_UNUSED_FUNC bool TryRunOneJob(JobSystem* system) {
+  JobWorker* worker = GetCurrentJobWorker(system);
+  Job*       job = FindJob(worker);
+  if (!job) return false;
+  RunJob(worker, job);
+  return true;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void* JobWorkerMain(void* param) {
+  JobWorker* worker = (JobWorker*)param;
+  JobSystem* system = worker->system;
+  jobThreadIndex = worker->index;
+
+  int idleSpins = 0;
+  while (atomic_load_explicit(&system->running, memory_order_acquire)) {
+    if (TryRunOneJob(system)) {
+      idleSpins = 0;
+      continue;
+    }
+    if (++idleSpins < JOB_IDLE_SPINS) {
+      sched_yield();
+      continue;
+    }
+
+    // Timed wait so a wake up racing with the sleep only costs one timeout, never a hang.
+    pthread_mutex_lock(&system->sleepMutex);
+    atomic_fetch_add(&system->sleepers, 1);
+    struct timespec wakeTime;
+    clock_gettime(CLOCK_REALTIME, &wakeTime);
+    wakeTime.tv_nsec += JOB_SLEEP_TIMEOUT_NS;
+    if (wakeTime.tv_nsec >= 1000000000L) {
+      wakeTime.tv_sec++;
+      wakeTime.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&system->sleepCond, &system->sleepMutex, &wakeTime);
+    atomic_fetch_sub(&system->sleepers, 1);
+    pthread_mutex_unlock(&system->sleepMutex);
+    idleSpins = 0;
+  }
+  return 0;
+}
+
+// ::JOB SYSTEM API
+static MARK_IGNORE_UNUSED_FUNC size_t JobSystemArenaSize(int threadCount, size_t scratchSize) {
+  if (threadCount <= 0) threadCount = GetCoreCount();
+  size_t perThread = AlignUpMaxAlignment(sizeof(JobWorker)) + AlignUpMaxAlignment(sizeof(MemoryArena)) + AlignUpMaxAlignment(scratchSize);
+  return AlignUpMaxAlignment(sizeof(JobSystem)) + 64 + perThread * (size_t)threadCount;
+}
+
+// threadCount <= 0 uses one thread per core. scratchSize is per thread.
+static MARK_IGNORE_UNUSED_FUNC JobSystem* CreateJobSystem(MemoryArena* arena, int threadCount, size_t scratchSize) {
+  if (threadCount <= 0) threadCount = GetCoreCount();
+  if (threadCount > JOB_MAX_THREADS) threadCount = JOB_MAX_THREADS;
+
+  JobSystem* system = PushType(arena, JobSystem);
+  memset(system, 0, sizeof(JobSystem));
+  system->threadCount = threadCount;
+  system->workers = (JobWorker*)PushSizeAligned_(arena, sizeof(JobWorker) * threadCount, 64);
+  memset(system->workers, 0, sizeof(JobWorker) * threadCount);
+  atomic_store(&system->running, 1);
+  pthread_mutex_init(&system->sleepMutex, 0);
+  pthread_cond_init(&system->sleepCond, 0);
+
+  for (int i = 0; i < threadCount; i++) {
+    JobWorker* worker = &system->workers[i];
+    worker->system = system;
+    worker->index = i;
+    worker->rng = 0x9E3779B9u * (uint32_t)(i + 1);
+    worker->scratch = CreateSubMemArena(arena, scratchSize);
+  }
+  jobThreadIndex = 0;
+  for (int i = 1; i < threadCount; i++) {
+    pthread_create(&system->workers[i].thread, 0, JobWorkerMain, &system->workers[i]);
+  }
+  return system;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void DestroyJobSystem(JobSystem* system) {
+  atomic_store(&system->running, 0);
+  pthread_mutex_lock(&system->sleepMutex);
+  pthread_cond_broadcast(&system->sleepCond);
+  pthread_mutex_unlock(&system->sleepMutex);
+  for (int i = 1; i < system->threadCount; i++) pthread_join(system->workers[i].thread, 0);
+  pthread_cond_destroy(&system->sleepCond);
+  pthread_mutex_destroy(&system->sleepMutex);
+}
+
+static MARK_IGNORE_UNUSED_FUNC void WakeJobWorkers(JobSystem* system) {
+  if (atomic_load_explicit(&system->sleepers, memory_order_relaxed) == 0) return;
+  pthread_mutex_lock(&system->sleepMutex);
+  pthread_cond_broadcast(&system->sleepCond);
+  pthread_mutex_unlock(&system->sleepMutex);
+}
+
+// Owner only. Skips slots still queued or running, returns NULL if every one of them is.
+static MARK_IGNORE_UNUSED_FUNC Job* AllocJob(JobWorker* worker, Job init) {
+  for (uint32_t i = 0; i < JOB_POOL_SIZE; i++) {
+    Job* job = &worker->pool[worker->poolNext++ & (JOB_POOL_SIZE - 1)];
+    if (atomic_load_explicit(&job->inUse, memory_order_acquire)) continue;
+    *job = init;
+    atomic_store_explicit(&job->inUse, 1, memory_order_relaxed); // Published with the deque push.
+    return job;
+  }
+  return 0;
+}
+
+// Pushes onto the calling thread's deque. Runs the job inline if the deque is full.
+static MARK_IGNORE_UNUSED_FUNC void SubmitJob_(JobSystem* system, Job* job) {
+  JobWorker* worker = GetCurrentJobWorker(system);
+  if (job->counter) atomic_fetch_add_explicit(&job->counter->pending, 1, memory_order_relaxed);
+  if (!JobDequePush(&worker->deque, job)) {
+    RunJob(worker, job);
+    return;
+  }
+  WakeJobWorkers(system);
+}
+
+// NOTE: Submit only from the main thread or from inside a job, other threads have no deque of their own.
+// Runs the job inline when the calling thread's pool is all in flight.
+static MARK_IGNORE_UNUSED_FUNC void SubmitJob(JobSystem* system, JobFunc func, void* data, JobCounter* counter) {
+  JobWorker* worker = GetCurrentJobWorker(system);
+  Job*       job = AllocJob(worker, (Job){.func = func, .data = data, .counter = counter});
+  if (!job) {
+    Job inlineJob = {.func = func, .data = data};
+    RunJob(worker, &inlineJob);
+    return;
+  }
+  SubmitJob_(system, job);
+}
+
+// Helps run jobs until every job tracked by counter has finished.
+static MARK_IGNORE_UNUSED_FUNC void WaitForCounter(JobSystem* system, JobCounter* counter) {
+  while (atomic_load_explicit(&counter->pending, memory_order_acquire) > 0) {
+    if (!TryRunOneJob(system)) sched_yield();
+  }
+}
+
+// ::PARALLEL FOR
+// func is called with disjoint [start, end) ranges covering [0, count), each at most grainSize long.
+// Ranges are split in half recursively so idle workers steal big halves instead of many tiny jobs.
+// Once the pool has no free job left, the rest of a range runs inline, grain by grain.
+typedef void (*ParallelForFunc)(void* data, uint32_t start, uint32_t end, MemoryArena* scratch);
+
+struct ParallelForData {
+  ParallelForFunc func;
+  void*           data;
+  uint32_t        grainSize;
+  JobCounter*     counter;
+  JobSystem*      system;
+};
+
+static void RunParallelForRange(JobWorker* worker, ParallelForData* pfor, uint32_t start, uint32_t end) {
+  while (end - start > pfor->grainSize) {
+    uint32_t mid = start + (end - start) / 2;
+    Job*     half = AllocJob(worker, (Job){.counter = pfor->counter, .parallelFor = pfor, .start = mid, .end = end});
+    if (!half) break;
+    SubmitJob_(pfor->system, half);
+    end = mid;
+  }
+  for (; end - start > pfor->grainSize; start += pfor->grainSize) pfor->func(pfor->data, start, start + pfor->grainSize, worker->scratch);
+  pfor->func(pfor->data, start, end, worker->scratch);
+}
+
+// Splits [0, count) across the workers and waits for all of it to finish.
+static MARK_IGNORE_UNUSED_FUNC void ParallelFor(JobSystem* system, uint32_t count, uint32_t grainSize, ParallelForFunc func, void* data) {
+  if (count == 0) return;
+  if (grainSize == 0) grainSize = 1;
+  JobCounter      counter = {0};
+  ParallelForData pfor = {func, data, grainSize, &counter, system};
+
+  JobWorker* worker = GetCurrentJobWorker(system);
+  TempMemory scratchMemory = BeginTempMemory(worker->scratch);
+  RunParallelForRange(worker, &pfor, 0, count);
+  EndTempMemory(scratchMemory);
+  WaitForCounter(system, &counter);
+}
+
+#endif // !JOB_SYSTEM_H
@@ -0,0 +1,147 @@
+#ifndef LAYER_CACHE_H
+#define LAYER_CACHE_H
+
+#include "include/raylib.h"
+#include "include/rlgl.h"
+#include "mem_arena.h"
+#include "render_commands.h"
+#include "utils.h"
+#include <stdint.h>
+#include <string.h>
+
+// ::LAYER CACHE
+// Retained layers for content that rarely changes: banners, UI panels, dialogs, tilemap
+// regions. Each layer is drawn once into its own RenderTexture2D and then composited as a
+// single quad per frame until it is invalidated.
+// A layer's bounds are in the space of the RenderLayer it's pushed into (screen space for UI,
+// world space under the world camera), and its draw function draws in that same space.
+// NOTE: Layers are drawn with premultiplied alpha so translucent content composites the same
+// as if it had been drawn directly.
+#define LAYER_CACHE_MAX_LAYERS 16
+#define LAYER_CACHE_INVALID UINT32_MAX
+
+typedef void (*CachedLayerDrawFunc)(void* data);
+
+typedef struct CachedLayer {
+  const char*         name;
+  Rectangle           bounds;
+  CachedLayerDrawFunc draw;
+  void*               data;
+  RenderTexture2D     target; // Loaded on first use, needs the window.
+  bool                dirty;
+  bool                visible;
+  uint32_t            redrawCount;
+} CachedLayer;
+
+typedef struct LayerCache {
+  CachedLayer layers[LAYER_CACHE_MAX_LAYERS];
+  uint32_t    layerCount;
+  uint32_t    redrawsLastUpdate;
+} LayerCache;
+
+static MARK_IGNORE_UNUSED_FUNC LayerCache* CreateLayerCache(MemoryArena* arena) {
+  LayerCache* cache = PushType(arena, LayerCache);
+  memset(cache, 0, sizeof(LayerCache));
+  return cache;
+}
+
+// Returns the layer's id, or LAYER_CACHE_INVALID if the cache is full.
+static MARK_IGNORE_UNUSED_FUNC uint32_t AddCachedLayer(LayerCache* cache, const char* name, Rectangle bounds, CachedLayerDrawFunc draw, void* data) {
+  if (cache->layerCount == LAYER_CACHE_MAX_LAYERS) {
+    TraceLog(LOG_WARNING, "LAYERS: Cache full, %s won't be drawn", name);
+    return LAYER_CACHE_INVALID;
+  }
+  CachedLayer* layer = &cache->layers[cache->layerCount];
+  *layer = (CachedLayer){0};
+  layer->name = name;
+  layer->bounds = bounds;
+  layer->draw = draw;
+  layer->data = data;
+  layer->dirty = true;
+  layer->visible = true;
+  return cache->layerCount++;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void InvalidateCachedLayer(LayerCache* cache, uint32_t id) {
+  if (id < cache->layerCount) cache->layers[id].dirty = true;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void InvalidateAllCachedLayers(LayerCache* cache) {
+  for (uint32_t i = 0; i < cache->layerCount; i++) cache->layers[i].dirty = true;
+}
+
+// Hidden layers are neither redrawn nor composited, but keep their texture.
+static MARK_IGNORE_UNUSED_FUNC void SetCachedLayerVisible(LayerCache* cache, uint32_t id, bool visible) {
+  if (id < cache->layerCount) cache->layers[id].visible = visible;
+}
+
+// A new size reallocates the texture on the next update.
+static MARK_IGNORE_UNUSED_FUNC void SetCachedLayerBounds(LayerCache* cache, uint32_t id, Rectangle bounds) {
+  if (id >= cache->layerCount) return;
+  CachedLayer* layer = &cache->layers[id];
+  if ((int)bounds.width != layer->target.texture.width || (int)bounds.height != layer->target.texture.height) {
+    if (IsRenderTextureValid(layer->target)) UnloadRenderTexture(layer->target);
+    layer->target = (RenderTexture2D){0};
+  }
+  layer->bounds = bounds;
+  layer->dirty = true;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void RedrawCachedLayer(CachedLayer* layer) {
+  if (!IsRenderTextureValid(layer->target)) {
+    layer->target = LoadRenderTexture((int)layer->bounds.width, (int)layer->bounds.height);
+    if (!IsRenderTextureValid(layer->target)) {
+      TraceLog(LOG_ERROR, "LAYERS: Failed to create a %dx%d texture for %s", (int)layer->bounds.width, (int)layer->bounds.height, layer->name);
+      layer->visible = false;
+      return;
+    }
+  }
+
+  BeginTextureMode(layer->target);
+  ClearBackground(BLANK);
+  // Colour blends as usual, alpha accumulates, which leaves the texture premultiplied.
+  rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+  BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+  BeginMode2D((Camera2D){.offset = {0, 0}, .target = {layer->bounds.x, layer->bounds.y}, .rotation = 0, .zoom = 1});
+  layer->draw(layer->data);
+  EndMode2D();
+  EndBlendMode();
+  EndTextureMode();
+
+  layer->dirty = false;
+  layer->redrawCount++;
+}
+
+// Redraws the dirty, visible layers. Main thread only, outside BeginDrawing.
+static MARK_IGNORE_UNUSED_FUNC uint32_t UpdateCachedLayers(LayerCache* cache) {
+  uint32_t redraws = 0;
+  for (uint32_t i = 0; i < cache->layerCount; i++) {
+    CachedLayer* layer = &cache->layers[i];
+    if (!layer->visible || !layer->dirty) continue;
+    RedrawCachedLayer(layer);
+    redraws++;
+  }
+  cache->redrawsLastUpdate = redraws;
+  return redraws;
+}
+
+// Composites the layer into renderLayer as one quad, if it's visible and has been drawn.
+static MARK_IGNORE_UNUSED_FUNC void PushCachedLayer(LayerCache* cache, uint32_t id, RenderCommandBuffer* buffer, RenderLayer renderLayer, float depth) {
+  if (id >= cache->layerCount) return;
+  CachedLayer* layer = &cache->layers[id];
+  if (!layer->visible || !IsRenderTextureValid(layer->target)) return;
+
+  RenderCommand command = {.type = RENDER_CMD_LAYER};
+  command.layer.texture = layer->target.texture;
+  command.layer.position = (Vector2){layer->bounds.x, layer->bounds.y};
+  PushRenderCommand(buffer, MakeRenderKey(renderLayer, RENDER_PHASE_DRAW, 0, RENDER_TEXTURE_LAYERS, depth), command);
+}
+
+static MARK_IGNORE_UNUSED_FUNC void DestroyLayerCache(LayerCache* cache) {
+  for (uint32_t i = 0; i < cache->layerCount; i++) {
+    if (IsRenderTextureValid(cache->layers[i].target)) UnloadRenderTexture(cache->layers[i].target);
+  }
+  cache->layerCount = 0;
+}
+
+#endif // !LAYER_CACHE_H
@@ -2,20 +2,253 @@
 #include "include/raylib.h"
 #include "input_utils.h"
 #include "texture_packer_utils.h"
+#include "asset_loader.h"
+#include "hot_reload.h"
 #include "mem_arena.h"
+#include "ecs.h"
+#include "systems.h"
+#include "simd_kernels.h"
+#include "raymath_batch.h"
+#include "job_system.h"
+#include "task_graph.h"
+#include "layer_cache.h"
+#include "text_cache.h"
+#include "benchmark.h"
+
+// ::FRAME TASKS
+// World data the frame tasks read and write. The task graph orders tasks that touch the same
+// resource, everything else is free to overlap.
+typedef enum FrameResource {
+  RES_INPUT = 1 << 0,      // consumableInputs, moveDirs
+  RES_APP_STATE = 1 << 1,  // Exit dialog state, overlay toggles
+  RES_ECS = 1 << 2,        // Entities and their components
+  RES_CONTACTS = 1 << 3,   // contacts, arenaFrame
+  RES_RENDER_PACKET = 1 << 4, // renderPacket, arenaRender
+  RES_BENCH = 1 << 5,      // Benchmark scene
+} FrameResource;
+
+typedef struct FrameContext {
+  float             deltaTime;
+  bool              exitWindowRequested;
+  bool              exitWindow;
+  bool              showRenderStats; // F3
+  Vector2           moveDirs[MAX_PLAYERS];
+  EcsCommandBuffer* ecsCommands;
+  MemoryArena*      arenaFrame;
+  MemoryArena*      arenaRender;
+  CollisionContacts contacts;
+  SpriteBatch*      spriteBatch; // Replays the render commands' sprites.
+  LayerCache*       layers;
+  TextCache*        textCache;
+  uint32_t          backgroundLayer;
+  uint32_t          exitDialogLayer;
+  YSortIndex*       worldYSort;
+  uint32_t          renderCommandCapacity;
+  RenderPacket      renderPacket;
+  RenderStats       lastRenderStats; // Last frame's, this one's are still being counted.
+  Rectangle         view; // World space rect the camera sees this frame.
+  JobSystem*        jobs;
+  TaskGraph*        graph;
+  BenchmarkScene*   benchScene;
+  int               screenWidth;
+  int               screenHeight;
+} FrameContext;
+
+static void InputTask(void* data) {
+  FrameContext* frame = (FrameContext*)data;
+  pollInputs();
+
+  if (frame->exitWindowRequested) {
+    if (tryConsumeInput(INPUT_Y_PRESSED) || tryConsumeInput(INPUT_ENTER_PRESSED) || tryConsumeInput(INPUT_GPAD_FACE_A_PRESSED))
+      frame->exitWindow = true;
+    else if (tryConsumeInput(INPUT_N_PRESSED) || tryConsumeInput(INPUT_ESC_PRESSED) || tryConsumeInput(INPUT_GPAD_FACE_B_PRESSED))
+      frame->exitWindowRequested = false;
+  } else if (WindowShouldClose() || tryConsumeInput(INPUT_ESC_PRESSED) || tryConsumeInput(INPUT_GPAD_START_PRESSED))
+    frame->exitWindowRequested = true;
+
+  if (tryConsumeInput(INPUT_F3_PRESSED)) frame->showRenderStats = !frame->showRenderStats;
+
+  Vector2* moveDirs = frame->moveDirs;
+  moveDirs[0] = (Vector2){consumableInputs->gamepadLeftX, consumableInputs->gamepadLeftY};
+  moveDirs[1] = (Vector2){consumableInputs->gamepadRightX, consumableInputs->gamepadRightY};
+  if (tryConsumeInput(INPUT_A_DOWN)) moveDirs[0].x -= 1;
+  if (tryConsumeInput(INPUT_D_DOWN)) moveDirs[0].x += 1;
+  if (tryConsumeInput(INPUT_W_DOWN)) moveDirs[0].y -= 1;
+  if (tryConsumeInput(INPUT_S_DOWN)) moveDirs[0].y += 1;
+
+  if (tryConsumeInput(INPUT_LEFT_DOWN)) moveDirs[1].x -= 1;
+  if (tryConsumeInput(INPUT_RIGHT_DOWN)) moveDirs[1].x += 1;
+  if (tryConsumeInput(INPUT_UP_DOWN)) moveDirs[1].y -= 1;
+  if (tryConsumeInput(INPUT_DOWN_DOWN)) moveDirs[1].y += 1;
+}
+
+static void PlayerControlTask(void* data) {
+  FrameContext* frame = (FrameContext*)data;
+  PlayerControlSystem(world->ecs, frame->moveDirs);
+}
+
+static void MovementTask(void* data) {
+  FrameContext* frame = (FrameContext*)data;
+  MovementSystem(world->ecs, frame->deltaTime);
+}
+
+static void CollisionTask(void* data) {
+  FrameContext* frame = (FrameContext*)data;
+  ResetArena(frame->arenaFrame);
+  frame->contacts = CollisionSystem(world->ecs, frame->arenaFrame);
+}
+
+static void RenderPacketTask(void* data) {
+  FrameContext* frame = (FrameContext*)data;
+  ResetArena(frame->arenaRender);
+  frame->view = GetCameraViewRect(world->camera, frame->screenWidth, frame->screenHeight);
+  RenderCommandBuffer* commands = CreateRenderCommandBuffer(frame->arenaRender, frame->renderCommandCapacity, RENDER_TEXT_POOL_SIZE);
+  frame->renderPacket = BuildRenderPacket(world->ecs, world->camera, frame->view, frame->worldYSort, commands, frame->arenaRender);
+}
+
+static void EcsFlushTask(void* data) {
+  FrameContext* frame = (FrameContext*)data;
+  EcsFlushCommands(world->ecs, frame->ecsCommands); // Apply structural changes queued by systems.
+}
+
+static void BenchmarkUpdateTask(void* data) {
+  FrameContext* frame = (FrameContext*)data;
+  UpdateBenchmarkScene(frame->benchScene, frame->jobs, frame->deltaTime);
+}
+
+// ::CACHED LAYERS
+// Static screen content, drawn once into a layer_cache.h texture instead of every frame.
+static void DrawBackgroundLayer(void* data) {
+  FrameContext* frame = (FrameContext*)data;
+  Texture2D     logo = GetDrawTexture(TEX_RAYLIB_LOGO);
+  DrawTexture(logo, (frame->screenWidth - logo.width) / 2, (frame->screenHeight - logo.height) / 2, (Color){255, 255, 255, 16});
+  DrawText("raylib is the best thing since sliced bread!", 190, 20, 20, LIGHTGRAY);
+
+#if DEBUG
+  DrawText("This is a debug build", 190, 50, 20, LIGHTGRAY);
+#endif
+
+#if !DEBUG
+  DrawText("This is a release build", 190, 50, 20, LIGHTGRAY);
+#endif
+}
+
+static void DrawExitDialogLayer(void* data) {
+  FrameContext* frame = (FrameContext*)data;
+  DrawRectangle(0, 0, frame->screenWidth, frame->screenHeight, (Color){0, 0, 0, 128});
+  DrawRectangle(0, 100, frame->screenWidth, 200, RAYWHITE);
+  DrawText("Are you sure you want to exit program? [Y/N]", 40, 180, 30, BLACK);
+}
+
+static void DrawBenchmarkCallback(void* data) {
+  FrameContext* frame = (FrameContext*)data;
+  DrawBenchmarkScene(frame->benchScene, frame->view);
+}
+
+// Text goes one layer above its panel, a rect would sort after the font's glyphs within a layer.
+static void PushRenderStatsOverlay(FrameContext* frame, RenderCommandBuffer* commands) {
+  const int         FONT_SIZE = 20;
+  const int         LINE_HEIGHT = 22;
+  const int         LINE_COUNT = 8;
+  const float       MB = 1024.0f * 1024.0f;
+  RenderStats       stats = frame->lastRenderStats;
+  TextureCacheStats textureStats = GetTextureCacheStats();
+  Rectangle         panel = (Rectangle){10, frame->screenHeight - 10 - (LINE_COUNT * LINE_HEIGHT + 16), 400, LINE_COUNT * LINE_HEIGHT + 16};
+  PushRenderRect(commands, RENDER_LAYER_UI, 1, panel, (Color){0, 0, 0, 160});
+
+  int x = (int)panel.x + 8, y = (int)panel.y + 8;
+  PushCachedRenderText(frame->textCache, commands, RENDER_LAYER_OVERLAY, TextFormat("draw calls: %u", stats.drawCalls), x, y, FONT_SIZE, RAYWHITE);
+  PushCachedRenderText(frame->textCache, commands, RENDER_LAYER_OVERLAY, TextFormat("batch flushes: %u", stats.batchFlushes), x, y + LINE_HEIGHT, FONT_SIZE, RAYWHITE);
+  PushCachedRenderText(frame->textCache, commands, RENDER_LAYER_OVERLAY, TextFormat("vertices: %u", stats.vertices), x, y + LINE_HEIGHT * 2, FONT_SIZE, RAYWHITE);
+  PushCachedRenderText(frame->textCache, commands, RENDER_LAYER_OVERLAY, TextFormat("texture switches: %u", stats.textureSwitches), x, y + LINE_HEIGHT * 3, FONT_SIZE, RAYWHITE);
+  PushCachedRenderText(frame->textCache, commands, RENDER_LAYER_OVERLAY, TextFormat("sprites: %u drawn, %u culled", stats.spritesDrawn, stats.spritesCulled), x, y + LINE_HEIGHT * 4, FONT_SIZE, RAYWHITE);
+  PushCachedRenderText(frame->textCache, commands, RENDER_LAYER_OVERLAY, TextFormat("commands: %u, layer redraws: %u", stats.commands, stats.layerRedraws), x, y + LINE_HEIGHT * 5, FONT_SIZE, RAYWHITE);
+  PushCachedRenderText(frame->textCache, commands, RENDER_LAYER_OVERLAY, TextFormat("textures: %u resident, %.1f / %.0f MB", textureStats.residentCount, textureStats.residentBytes / MB, textureStats.budgetBytes / MB), x, y + LINE_HEIGHT * 6, FONT_SIZE, textureStats.overBudget ? ORANGE : RAYWHITE);
+  PushCachedRenderText(frame->textCache, commands, RENDER_LAYER_OVERLAY, TextFormat("evictions: %u, reloads: %u", textureStats.evictions, textureStats.reloads), x, y + LINE_HEIGHT * 7, FONT_SIZE, RAYWHITE);
+}
+
+static void RenderTask(void* data) {
+  FrameContext*        frame = (FrameContext*)data;
+  RenderCommandBuffer* commands = frame->renderPacket.commands;
+
+  BeginRenderStats();
+  SetCachedLayerVisible(frame->layers, frame->exitDialogLayer, frame->exitWindowRequested);
+  renderStats.layerRedraws = UpdateCachedLayers(frame->layers); // Before BeginDrawing, redraws go to their own textures.
+  PushCachedLayer(frame->layers, frame->backgroundLayer, commands, RENDER_LAYER_BACKGROUND, 0);
+  PushCachedLayer(frame->layers, frame->exitDialogLayer, commands, RENDER_LAYER_OVERLAY, 0);
+
+  if (frame->benchScene) PushRenderCallback(commands, RENDER_LAYER_WORLD, -1, DrawBenchmarkCallback, frame); // Under the Y sorted world sprites.
+
+#if DEBUG
+  PushCachedRenderText(frame->textCache, commands, RENDER_LAYER_UI, TextFormat("contacts: %u", frame->contacts.pairCount), 190, 80, 20, LIGHTGRAY);
+  // Last frame's numbers, this one is still running.
+  PushCachedRenderText(frame->textCache, commands, RENDER_LAYER_UI, TextFormat("critical path: %.2f ms of %.2f ms", frame->graph->criticalPathMs, frame->graph->frameMs), 190, 110, 20, LIGHTGRAY);
+#endif
+  if (frame->showRenderStats) PushRenderStatsOverlay(frame, commands);
+
+  SortRenderCommands(commands);
+  BeginDrawing();
+  ClearBackground(RAYWHITE);
+  ExecuteRenderCommands(commands, frame->spriteBatch);
+  EndDrawing();
+
+  renderStats.spritesCulled = frame->renderPacket.cull.culled;
+  if (frame->benchScene) renderStats.spritesCulled += frame->benchScene->frameStats[frame->benchScene->frameIndex].culledCount; // Drawn during replay.
+  frame->lastRenderStats = EndRenderStats();
+}
+
+int main(int argc, char** argv) {
+  BenchmarkConfig benchConfig = ParseBenchmarkArgs(argc, argv);
 
-int main(void) {
   const int screenWidth = 800;
   const int screenHeight = 450;
+  if (benchConfig.headless) SetConfigFlags(FLAG_WINDOW_HIDDEN);
   InitWindow(screenWidth, screenHeight, "raylib [core] example - basic window");
-  SetTargetFPS(60);
+  SetTargetFPS(benchConfig.enabled ? 0 : 60); // Benchmarks run uncapped.
   SetExitKey(KEY_NULL);
-  bool exitWindowRequested = false;
-  bool exitWindow = false;
 
-  MemoryArena* arenaMain = CreateMemoryArena(1024 * 1024);
+  const uint32_t MAX_ENTITIES = 4096;
+  const uint32_t TEXT_CACHE_ENTRIES = 256;
+  const uint32_t TEXT_CACHE_GLYPHS = 8192;
+  MemoryArena*   arenaMain = CreateMemoryArena(1024 * 1024 + SpriteBatchArenaSize(MAX_ENTITIES) + YSortIndexArenaSize(MAX_ENTITIES) + TextCacheArenaSize(TEXT_CACHE_ENTRIES, TEXT_CACHE_GLYPHS));
+  // Reset every frame. One per task that allocates, so those tasks can run concurrently.
+  MemoryArena* arenaFrame = CreateMemoryArena(4 * 1024 * 1024);
+  const uint32_t RENDER_COMMAND_CAPACITY = MAX_ENTITIES + 2048; // Sprites plus cameras and UI glyphs.
+  MemoryArena*   arenaRender = CreateMemoryArena(1024 * 1024 + RenderCommandBufferArenaSize(RENDER_COMMAND_CAPACITY, RENDER_TEXT_POOL_SIZE));
 
-  LoadAllTexturesAndSprites();
+  const size_t JOB_SCRATCH_SIZE = 256 * 1024;
+  MemoryArena* arenaJobs = CreateMemoryArena(JobSystemArenaSize(0, JOB_SCRATCH_SIZE));
+  JobSystem*   jobs = CreateJobSystem(arenaJobs, 0, JOB_SCRATCH_SIZE);
+
+  // Decoded atlases wait in staging for their upload, one atlas per loader thread fits. One thread
+  // per atlas, plus one for loose textures, up to ASSET_LOADER_MAX_THREADS.
+  const int    ASSET_LOADER_THREADS = ATLAS_COUNT + 1;
+  const size_t ASSET_STAGING_SIZE = (size_t)GetPixelDataSize(GetLargestAtlasSize(), GetLargestAtlasSize(), PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+  const double ASSET_UPLOAD_BUDGET_MS = 2.0;
+  MemoryArena* arenaAssets = CreateMemoryArena(AssetLoaderArenaSize(ASSET_LOADER_THREADS, ASSET_STAGING_SIZE));
+  AssetLoader* assets = CreateAssetLoader(arenaAssets, ASSET_LOADER_THREADS, ASSET_STAGING_SIZE);
+  MountResourcePack(); // Release builds ship one. Debug builds still read loose files first, hot reload writes those.
+  LoadAllTexturesAndSprites(assets);
+  if (benchConfig.enabled) WaitForAssetLoader(assets); // Every run measures the same textures from frame 0.
+#if DEBUG
+  HotReload* hotReload = CreateHotReload(arenaMain);
+  for (int i = 0; i < ATLAS_COUNT; i++) {
+    const AtlasInfo* atlas = &ATLASES[i];
+    AddHotReloadAtlas(hotReload, arenaMain, atlas->texture, atlas->sourceFolder, atlas->imageFile, atlas->textureFile, atlas->metaFile, atlas->sprites, atlas->spriteCount);
+  }
+  if (!benchConfig.enabled) StartHotReload(hotReload);
+#endif
+
+  TraceLog(LOG_INFO, "SIMD: Using %s kernels", SIMD_LEVEL_NAMES[GetSimdLevel()]);
+#if DEBUG
+  if (!SimdKernelsSelfCheck() || !RaymathBatchSelfCheck()) {
+    TraceLog(LOG_WARNING, "SIMD: Self check failed, falling back to scalar kernels");
+    SetSimdLevel(SIMD_SCALAR);
+  }
+  bool spriteBatchChecked = SpriteBatchSelfCheck();
+  assert(spriteBatchChecked && "Sprite batch self check failed, see the log");
+  (void)spriteBatchChecked; // NDEBUG builds.
+#endif
 
   // ::INIT
   world = PushType(arenaMain, World);
@@ -29,105 +262,82 @@ int main(void) {
   world->camera.rotation = 0;
   world->camera.zoom = 1.0f;
 
-  world->player1Pos = (Vector2){-100, 0};
-  world->player2Pos = (Vector2){100, 0};
-
-  while (!exitWindow) {
-    float deltaTime = GetFrameTime();
-
-    { // ::INPUT
-      pollInputs();
-
-      if (exitWindowRequested) {
-        if (tryConsumeInput(INPUT_Y_PRESSED) || tryConsumeInput(INPUT_ENTER_PRESSED) || tryConsumeInput(INPUT_GPAD_FACE_A_PRESSED))
-          exitWindow = true;
-        else if (tryConsumeInput(INPUT_N_PRESSED) || tryConsumeInput(INPUT_ESC_PRESSED) || tryConsumeInput(INPUT_GPAD_FACE_B_PRESSED))
-          exitWindowRequested = false;
-      } else if (WindowShouldClose() || tryConsumeInput(INPUT_ESC_PRESSED) || tryConsumeInput(INPUT_GPAD_START_PRESSED))
-        exitWindowRequested = true;
-
-      const float MOVEMENT_SPEED = 50.0f;
-      if (tryConsumeInput(INPUT_A_DOWN)) world->player1Pos.x -= MOVEMENT_SPEED * deltaTime;
-      if (tryConsumeInput(INPUT_D_DOWN)) world->player1Pos.x += MOVEMENT_SPEED * deltaTime;
-      if (tryConsumeInput(INPUT_W_DOWN)) world->player1Pos.y -= MOVEMENT_SPEED * deltaTime;
-      if (tryConsumeInput(INPUT_S_DOWN)) world->player1Pos.y += MOVEMENT_SPEED * deltaTime;
-
-      if (tryConsumeInput(INPUT_LEFT_DOWN)) world->player2Pos.x -= MOVEMENT_SPEED * deltaTime;
-      if (tryConsumeInput(INPUT_RIGHT_DOWN)) world->player2Pos.x += MOVEMENT_SPEED * deltaTime;
-      if (tryConsumeInput(INPUT_UP_DOWN)) world->player2Pos.y -= MOVEMENT_SPEED * deltaTime;
-      if (tryConsumeInput(INPUT_DOWN_DOWN)) world->player2Pos.y += MOVEMENT_SPEED * deltaTime;
-
-      world->player1Pos.x += consumableInputs->gamepadLeftX * MOVEMENT_SPEED * deltaTime;
-      world->player1Pos.y += consumableInputs->gamepadLeftY * MOVEMENT_SPEED * deltaTime;
-      world->player2Pos.x += consumableInputs->gamepadRightX * MOVEMENT_SPEED * deltaTime;
-      world->player2Pos.y += consumableInputs->gamepadRightY * MOVEMENT_SPEED * deltaTime;
-    }
+  world->ecs = CreateEcsWorld(arenaMain, MAX_ENTITIES);
+  SpawnPlayer(world->ecs, 0, (Vector2){-100, 0}, SPRITE_MAIN_PLAYER_1);
+  SpawnPlayer(world->ecs, 1, (Vector2){100, 0}, SPRITE_MAIN_PLAYER_2);
+
+  BenchmarkScene* benchScene = 0;
+  if (benchConfig.enabled) {
+    Rectangle benchBounds = (Rectangle){-screenWidth / 2.0f, -screenHeight / 2.0f, screenWidth, screenHeight};
+    benchScene = CreateBenchmarkScene(benchConfig, benchBounds);
+  }
 
-    { // ::RENDER
-      BeginDrawing();
-      {
-        ClearBackground(RAYWHITE);
-        Texture2D logo = textures[TEX_RAYLIB_LOGO];
-        DrawTexture(logo, (screenWidth - logo.width) / 2.0f, (screenHeight - logo.height) / 2.0f, (Color){255, 255, 255, 16});
-        DrawText("raylib is the best thing since sliced bread!", 190, 20, 20, LIGHTGRAY);
-
-        BeginMode2D(world->camera);
-
-        {
-          SpriteData player1Sprite = sprites[SPRITE_MAIN_PLAYER_1];
-          Rectangle  destRect = (Rectangle){
-              world->player1Pos.x - (player1Sprite.size.x / 2),
-              world->player1Pos.y - (player1Sprite.size.y / 2),
-              player1Sprite.size.x,
-              player1Sprite.size.y,
-          };
-          DrawTexturePro(textures[player1Sprite.sourceTexture],
-              player1Sprite.sourceRect,
-              destRect,
-              (Vector2){0, 0},
-              0,
-              WHITE);
-        }
-
-        {
-          SpriteData player2Sprite = sprites[SPRITE_MAIN_PLAYER_2];
-          Rectangle  destRect = (Rectangle){
-              world->player2Pos.x - (player2Sprite.size.x / 2),
-              world->player2Pos.y - (player2Sprite.size.y / 2),
-              player2Sprite.size.x,
-              player2Sprite.size.y,
-          };
-          DrawTexturePro(textures[player2Sprite.sourceTexture],
-              player2Sprite.sourceRect,
-              destRect,
-              (Vector2){0, 0},
-              0,
-              WHITE);
-        }
-
-        EndMode2D();
+  FrameContext* frame = PushType(arenaMain, FrameContext);
+  *frame = (FrameContext){0};
+  frame->ecsCommands = CreateEcsCommandBuffer(arenaMain, 1024, 16 * 1024);
+  frame->arenaFrame = arenaFrame;
+  frame->arenaRender = arenaRender;
+  frame->spriteBatch = CreateSpriteBatch(arenaMain, MAX_ENTITIES);
+  frame->worldYSort = CreateYSortIndex(arenaMain, MAX_ENTITIES);
+  frame->renderCommandCapacity = RENDER_COMMAND_CAPACITY;
+  frame->jobs = jobs;
+  frame->benchScene = benchScene;
+  frame->screenWidth = screenWidth;
+  frame->screenHeight = screenHeight;
 
-#if DEBUG
-        DrawText("This is a debug build", 190, 50, 20, LIGHTGRAY);
-#endif
+  Rectangle screenRect = (Rectangle){0, 0, screenWidth, screenHeight};
+  frame->layers = CreateLayerCache(arenaMain);
+  frame->textCache = CreateTextCache(arenaMain, TEXT_CACHE_ENTRIES, TEXT_CACHE_GLYPHS);
+  frame->backgroundLayer = AddCachedLayer(frame->layers, "background", screenRect, DrawBackgroundLayer, frame);
+  frame->exitDialogLayer = AddCachedLayer(frame->layers, "exit_dialog", screenRect, DrawExitDialogLayer, frame);
 
-#if !DEBUG
-        DrawText("This is a release build", 190, 50, 20, LIGHTGRAY);
+  // ::TASK GRAPH
+  // Declared once, in the order conflicting work must happen.
+  TaskGraph* graph = CreateTaskGraph(arenaMain);
+  frame->graph = graph;
+  AddFrameTask(graph, "input", InputTask, frame, 0, RES_INPUT | RES_APP_STATE, TASK_MAIN_THREAD);
+  AddFrameTask(graph, "player_control", PlayerControlTask, frame, RES_INPUT, RES_ECS, TASK_NONE);
+  AddFrameTask(graph, "movement", MovementTask, frame, 0, RES_ECS, TASK_NONE);
+  AddFrameTask(graph, "collision", CollisionTask, frame, RES_ECS, RES_CONTACTS, TASK_NONE);
+  AddFrameTask(graph, "render_packet", RenderPacketTask, frame, RES_ECS, RES_RENDER_PACKET, TASK_NONE);
+  AddFrameTask(graph, "ecs_flush", EcsFlushTask, frame, 0, RES_ECS, TASK_NONE);
+  if (benchScene) AddFrameTask(graph, "bench_update", BenchmarkUpdateTask, frame, 0, RES_BENCH, TASK_NONE);
+  AddFrameTask(graph, "render", RenderTask, frame, RES_APP_STATE | RES_CONTACTS, RES_RENDER_PACKET | RES_BENCH, TASK_MAIN_THREAD);
+
+  while (!frame->exitWindow) {
+    // NOTE: Benchmarks use a fixed step so every run simulates the same workload.
+    frame->deltaTime = benchScene ? 1.0f / 60.0f : GetFrameTime();
+
+    RunTaskGraph(graph, jobs);
+#if DEBUG
+    UpdateHotReload(hotReload, assets);
 #endif
-      }
-    }
+    if (UpdateAssetLoader(assets, ASSET_UPLOAD_BUDGET_MS) > 0) InvalidateAllCachedLayers(frame->layers); // They may draw the new textures.
+    UpdateTextureResidency(assets);
 
-    // EXIT WINDOW
-    if (exitWindowRequested) {
-      DrawRectangle(0, 0, screenWidth, screenHeight, (Color){0, 0, 0, 128});
-      DrawRectangle(0, 100, screenWidth, 200, RAYWHITE);
-      DrawText("Are you sure you want to exit program? [Y/N]", 40, 180, 30, BLACK);
+    if (benchScene) {
+      EndBenchmarkFrame(benchScene, arenaMain->used + arenaFrame->used + arenaRender->used, graph->criticalPathMs, frame->lastRenderStats);
+      if (IsBenchmarkComplete(benchScene)) frame->exitWindow = true;
     }
-
-    EndDrawing();
   }
 
+  if (benchScene) {
+    WriteBenchmarkResults(benchScene);
+    DestroyBenchmarkScene(benchScene);
+  }
+  DestroyLayerCache(frame->layers);
+#if DEBUG
+  DestroyHotReload(hotReload);
+#endif
+  DestroyAssetLoader(assets);
+  DestroyMemoryArena(arenaAssets);
   UnloadAllTextures();
+  UnmountResourcePack();
+  DestroyTaskGraph(graph);
+  DestroyJobSystem(jobs);
+  DestroyMemoryArena(arenaJobs);
+  DestroyMemoryArena(arenaRender);
+  DestroyMemoryArena(arenaFrame);
   DestroyMemoryArena(arenaMain);
   CloseWindow();
   return 0;
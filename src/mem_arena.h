@@ -25,6 +25,7 @@ static MARK_IGNORE_UNUSED_FUNC void InitArena(MemoryArena* arena, size_t size, v
   arena->size = size;
   arena->base = (uint8_t*)base;
   arena->used = 0;
+  arena->parent = 0;
 }
 static MARK_IGNORE_UNUSED_FUNC MemoryArena* CreateMemoryArena(size_t size) {
   MemoryArena* arena = (MemoryArena*)malloc(sizeof(MemoryArena));
@@ -81,6 +82,24 @@ static MARK_IGNORE_UNUSED_FUNC void* PushSize_(MemoryArena* arena, size_t size)
   return result;
 }
 
+// NOTE: For data that SIMD loops stream over, e.g. SoA float arrays. alignment must be a power of 2.
+#define PushArrayAligned(arena, count, type, alignment) (type*)PushSizeAligned_(arena, sizeof(type) * (count), alignment)
+static MARK_IGNORE_UNUSED_FUNC void* PushSizeAligned_(MemoryArena* arena, size_t size, size_t alignment) {
+  size_t alignedOffset = AlignUp((size_t)(arena->base + arena->used), alignment) - (size_t)arena->base;
+  size_t newUsed = alignedOffset + size;
+  assert(newUsed <= arena->size);
+  void* result = arena->base + alignedOffset;
+  arena->used = newUsed;
+  return result;
+}
+
+// Gives back the unused tail of the most recent push, e.g. a result array pushed at its worst case size.
+static MARK_IGNORE_UNUSED_FUNC void ShrinkLastPush(MemoryArena* arena, void* lastPush, size_t usedSize) {
+  uint8_t* newEnd = (uint8_t*)lastPush + usedSize;
+  assert((uint8_t*)lastPush >= arena->base && newEnd <= arena->base + arena->used);
+  arena->used = (size_t)(newEnd - arena->base);
+}
+
 // NOTE: Undecided if I want to keep this or just have seperate arenas instead.
 // Creates potential bugs should I forget to destroy root arena before sub arena and use stuff from sub arena...
 static MARK_IGNORE_UNUSED_FUNC MemoryArena* CreateSubMemArena(MemoryArena* sourceArena, size_t subArenaSize) {
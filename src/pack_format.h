@@ -0,0 +1,102 @@
+#ifndef PACK_FORMAT_H
+#define PACK_FORMAT_H
+
+#include "texture_format.h"
+#include "utils.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ::PACK FORMAT
+// Every runtime resource in one file (`nob pack`, RESOURCE_PACK_FILE), mapped once by the game
+// instead of opening files one by one:
+//   AssetPackHeader   at offset 0
+//   AssetPackEntry    entryCount entries at entryOffset, sorted by pathHash
+//   string pool       stringSize bytes at stringOffset, nul terminated paths
+//   blobs             each at an ASSET_PACK_ALIGNMENT aligned offset, in path order
+// Paths are relative to resources/ with '/' separators, e.g. "main_atlas.bin". A lookup is one
+// CRC32, a binary search over the hashes and a compare against the stored path. Blobs are stored
+// as they are, so they can be read in place, or as one LZ4 block (texture_format.h's format)
+// when that's much smaller. Page aligned blobs keep a read of one file to its own pages.
+// Values are little endian.
+// NOTE: Shared with nob.c, so no raylib in here. ComputeCRC32 comes from raylib in the game and
+// from nob_src/raylib_extracts.h in the packer, include one of them first.
+#define ASSET_PACK_MAGIC 0x4B415041u // "APAK"
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_ALIGNMENT 4096
+
+typedef enum AssetPackCompression {
+  ASSET_PACK_UNCOMPRESSED = 0,
+  ASSET_PACK_LZ4 = 1,
+} AssetPackCompression;
+
+typedef struct AssetPackHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entryCount;
+  uint32_t entryOffset; // From the start of the file.
+  uint32_t stringOffset;
+  uint32_t stringSize;
+} AssetPackHeader;
+
+typedef struct AssetPackEntry {
+  uint32_t pathHash;    // ComputeCRC32 of the path.
+  uint32_t pathOffset;  // Into the string pool.
+  uint32_t compression; // AssetPackCompression.
+  uint32_t reserved;
+  uint64_t offset; // From the start of the file, ASSET_PACK_ALIGNMENT aligned.
+  uint64_t storedSize;
+  uint64_t size; // Once decompressed.
+} AssetPackEntry;
+
+// Checks the header and that the tables lie inside the data. Entries are checked when found.
+static MARK_IGNORE_UNUSED_FUNC const AssetPackHeader* GetAssetPack(const void* data, size_t size) {
+  if (!data || size < sizeof(AssetPackHeader)) return NULL;
+  const AssetPackHeader* header = (const AssetPackHeader*)data;
+  if (header->magic != ASSET_PACK_MAGIC || header->version != ASSET_PACK_VERSION) return NULL;
+  if (header->entryOffset < sizeof(AssetPackHeader) || header->entryOffset % sizeof(uint64_t) != 0) return NULL;
+  if ((uint64_t)header->entryOffset + (uint64_t)header->entryCount * sizeof(AssetPackEntry) > size) return NULL;
+  if (header->stringSize == 0 || (uint64_t)header->stringOffset + header->stringSize > size) return NULL;
+  if (((const char*)data)[header->stringOffset + header->stringSize - 1] != '\0') return NULL; // Every path ends inside the pool.
+  return header;
+}
+
+static MARK_IGNORE_UNUSED_FUNC const AssetPackEntry* GetAssetPackEntries(const AssetPackHeader* header) {
+  return (const AssetPackEntry*)((const uint8_t*)header + header->entryOffset);
+}
+
+// NULL if path isn't in the pack, or its entry points outside of it.
+static MARK_IGNORE_UNUSED_FUNC const AssetPackEntry* FindAssetPackEntry(const AssetPackHeader* header, size_t packSize, const char* path) {
+  size_t                length = strlen(path);
+  uint32_t              hash = ComputeCRC32((unsigned char*)path, (int)length);
+  const AssetPackEntry* entries = GetAssetPackEntries(header);
+  const char*           strings = (const char*)header + header->stringOffset;
+
+  uint32_t low = 0, high = header->entryCount; // First entry with pathHash >= hash.
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    if (entries[mid].pathHash < hash) low = mid + 1;
+    else high = mid;
+  }
+  for (uint32_t i = low; i < header->entryCount && entries[i].pathHash == hash; i++) { // Colliding paths sit next to each other.
+    const AssetPackEntry* entry = &entries[i];
+    if (entry->pathOffset >= header->stringSize || strcmp(strings + entry->pathOffset, path) != 0) continue;
+    if (entry->storedSize > packSize || entry->offset > packSize - entry->storedSize) return NULL;
+    if (entry->compression == ASSET_PACK_UNCOMPRESSED && entry->storedSize != entry->size) return NULL;
+    if (entry->compression != ASSET_PACK_UNCOMPRESSED && entry->compression != ASSET_PACK_LZ4) return NULL;
+    return entry;
+  }
+  return NULL;
+}
+
+static MARK_IGNORE_UNUSED_FUNC const uint8_t* GetAssetPackData(const AssetPackHeader* header, const AssetPackEntry* entry) {
+  return (const uint8_t*)header + entry->offset;
+}
+
+// Decompresses an LZ4 entry into exactly entry->size bytes at out.
+static MARK_IGNORE_UNUSED_FUNC bool DecompressAssetPackEntry(const AssetPackHeader* header, const AssetPackEntry* entry, uint8_t* out) {
+  return DecompressRawTexture(GetAssetPackData(header, entry), (size_t)entry->storedSize, out, (size_t)entry->size);
+}
+
+#endif // !PACK_FORMAT_H
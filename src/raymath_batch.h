@@ -0,0 +1,348 @@
+#ifndef RAYMATH_BATCH_H
+#define RAYMATH_BATCH_H
+
+#include "include/raylib.h"
+#include "include/raymath.h"
+#include "simd_kernels.h"
+#include "utils.h"
+#include <stdint.h>
+#include <string.h>
+
+// ::RAYMATH BATCH
+// Array versions of the raymath/raylib helpers we call per entity: transform, length, distance,
+// AABB tests and lerp. Inputs are SoA float arrays (x and y in separate arrays), any float
+// alignment works but 64 byte aligned arrays (PushArrayAligned) keep loads on one cache line.
+// Paths are picked with GetSimdLevel like simd_kernels.h and give bit-identical results.
+// NOTE: Results can differ from the raymath function in the last bit where raymath folds the
+// operations in a different order, e.g. the z = 0 term in Vector2Transform.
+
+// ::RAYMATH BATCH SCALAR
+static MARK_IGNORE_UNUSED_FUNC void BatchTransformScalar(const float* x, const float* y, float* outX, float* outY, uint32_t count, Matrix mat) {
+  for (uint32_t i = 0; i < count; i++) {
+    float px = x[i], py = y[i];
+    float ax = mat.m0 * px, bx = mat.m4 * py;
+    float ay = mat.m1 * px, by = mat.m5 * py;
+    outX[i] = (ax + bx) + mat.m12;
+    outY[i] = (ay + by) + mat.m13;
+  }
+}
+
+static MARK_IGNORE_UNUSED_FUNC void BatchLengthScalar(const float* x, const float* y, float* out, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    float xx = x[i] * x[i];
+    float yy = y[i] * y[i];
+    out[i] = sqrtf(xx + yy);
+  }
+}
+
+static MARK_IGNORE_UNUSED_FUNC void BatchDistanceScalar(const float* ax, const float* ay, const float* bx, const float* by, float* out, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    float dx = ax[i] - bx[i], dy = ay[i] - by[i];
+    float xx = dx * dx;
+    float yy = dy * dy;
+    out[i] = sqrtf(xx + yy);
+  }
+}
+
+// Same rules as CheckCollisionPointRec: min edges inclusive, max edges exclusive.
+static MARK_IGNORE_UNUSED_FUNC uint32_t BatchCheckCollisionPointRecScalar(const float* x, const float* y, uint32_t count, Rectangle rec, uint8_t* outHits) {
+  float    maxX = rec.x + rec.width, maxY = rec.y + rec.height;
+  uint32_t hits = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    outHits[i] = x[i] >= rec.x && x[i] < maxX && y[i] >= rec.y && y[i] < maxY;
+    hits += outHits[i];
+  }
+  return hits;
+}
+
+// Same rules as CheckCollisionRecs: touching edges don't count.
+static MARK_IGNORE_UNUSED_FUNC uint32_t BatchCheckCollisionRecsScalar(const float* recX, const float* recY, const float* recW, const float* recH, uint32_t count, Rectangle rec, uint8_t* outHits) {
+  float    maxX = rec.x + rec.width, maxY = rec.y + rec.height;
+  uint32_t hits = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    float itemMaxX = recX[i] + recW[i], itemMaxY = recY[i] + recH[i];
+    outHits[i] = recX[i] < maxX && itemMaxX > rec.x && recY[i] < maxY && itemMaxY > rec.y;
+    hits += outHits[i];
+  }
+  return hits;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void BatchLerpScalar(const float* a, const float* b, float* out, uint32_t count, float amount) {
+  for (uint32_t i = 0; i < count; i++) {
+    float delta = (b[i] - a[i]) * amount;
+    out[i] = a[i] + delta;
+  }
+}
+
+#if SIMD_X86
+// ::RAYMATH BATCH SSE2
+SIMD_TARGET("sse2") static MARK_IGNORE_UNUSED_FUNC void BatchTransformSSE2(const float* x, const float* y, float* outX, float* outY, uint32_t count, Matrix mat) {
+  __m128   m0 = _mm_set1_ps(mat.m0), m1 = _mm_set1_ps(mat.m1), m4 = _mm_set1_ps(mat.m4), m5 = _mm_set1_ps(mat.m5);
+  __m128   m12 = _mm_set1_ps(mat.m12), m13 = _mm_set1_ps(mat.m13);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i);
+    _mm_storeu_ps(outX + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, px), _mm_mul_ps(m4, py)), m12));
+    _mm_storeu_ps(outY + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, px), _mm_mul_ps(m5, py)), m13));
+  }
+  BatchTransformScalar(x + i, y + i, outX + i, outY + i, count - i, mat);
+}
+
+SIMD_TARGET("sse2") static MARK_IGNORE_UNUSED_FUNC void BatchLengthSSE2(const float* x, const float* y, float* out, uint32_t count) {
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i);
+    _mm_storeu_ps(out + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py))));
+  }
+  BatchLengthScalar(x + i, y + i, out + i, count - i);
+}
+
+SIMD_TARGET("sse2") static MARK_IGNORE_UNUSED_FUNC void BatchDistanceSSE2(const float* ax, const float* ay, const float* bx, const float* by, float* out, uint32_t count) {
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 dx = _mm_sub_ps(_mm_loadu_ps(ax + i), _mm_loadu_ps(bx + i));
+    __m128 dy = _mm_sub_ps(_mm_loadu_ps(ay + i), _mm_loadu_ps(by + i));
+    _mm_storeu_ps(out + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))));
+  }
+  BatchDistanceScalar(ax + i, ay + i, bx + i, by + i, out + i, count - i);
+}
+
+// Writes the low `lanes` bits of a movemask as 0/1 bytes.
+static MARK_IGNORE_UNUSED_FUNC uint32_t StoreBatchHitMask(uint8_t* outHits, int mask, int lanes) {
+  for (int k = 0; k < lanes; k++) outHits[k] = (mask >> k) & 1;
+  return (uint32_t)__builtin_popcount(mask);
+}
+
+SIMD_TARGET("sse2") static MARK_IGNORE_UNUSED_FUNC uint32_t BatchCheckCollisionPointRecSSE2(const float* x, const float* y, uint32_t count, Rectangle rec, uint8_t* outHits) {
+  __m128   minX = _mm_set1_ps(rec.x), maxX = _mm_set1_ps(rec.x + rec.width);
+  __m128   minY = _mm_set1_ps(rec.y), maxY = _mm_set1_ps(rec.y + rec.height);
+  uint32_t hits = 0, i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i);
+    __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(px, minX), _mm_cmplt_ps(px, maxX)),
+        _mm_and_ps(_mm_cmpge_ps(py, minY), _mm_cmplt_ps(py, maxY)));
+    hits += StoreBatchHitMask(outHits + i, _mm_movemask_ps(inside), 4);
+  }
+  return hits + BatchCheckCollisionPointRecScalar(x + i, y + i, count - i, rec, outHits + i);
+}
+
+SIMD_TARGET("sse2") static MARK_IGNORE_UNUSED_FUNC uint32_t BatchCheckCollisionRecsSSE2(const float* recX, const float* recY, const float* recW, const float* recH, uint32_t count, Rectangle rec, uint8_t* outHits) {
+  __m128   minX = _mm_set1_ps(rec.x), maxX = _mm_set1_ps(rec.x + rec.width);
+  __m128   minY = _mm_set1_ps(rec.y), maxY = _mm_set1_ps(rec.y + rec.height);
+  uint32_t hits = 0, i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 x = _mm_loadu_ps(recX + i), y = _mm_loadu_ps(recY + i);
+    __m128 itemMaxX = _mm_add_ps(x, _mm_loadu_ps(recW + i)), itemMaxY = _mm_add_ps(y, _mm_loadu_ps(recH + i));
+    __m128 overlap = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(x, maxX), _mm_cmpgt_ps(itemMaxX, minX)),
+        _mm_and_ps(_mm_cmplt_ps(y, maxY), _mm_cmpgt_ps(itemMaxY, minY)));
+    hits += StoreBatchHitMask(outHits + i, _mm_movemask_ps(overlap), 4);
+  }
+  return hits + BatchCheckCollisionRecsScalar(recX + i, recY + i, recW + i, recH + i, count - i, rec, outHits + i);
+}
+
+SIMD_TARGET("sse2") static MARK_IGNORE_UNUSED_FUNC void BatchLerpSSE2(const float* a, const float* b, float* out, uint32_t count, float amount) {
+  __m128   t = _mm_set1_ps(amount);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 va = _mm_loadu_ps(a + i);
+    _mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), va), t)));
+  }
+  BatchLerpScalar(a + i, b + i, out + i, count - i, amount);
+}
+
+// ::RAYMATH BATCH AVX2
+SIMD_TARGET("avx2") static MARK_IGNORE_UNUSED_FUNC void BatchTransformAVX2(const float* x, const float* y, float* outX, float* outY, uint32_t count, Matrix mat) {
+  __m256   m0 = _mm256_set1_ps(mat.m0), m1 = _mm256_set1_ps(mat.m1), m4 = _mm256_set1_ps(mat.m4), m5 = _mm256_set1_ps(mat.m5);
+  __m256   m12 = _mm256_set1_ps(mat.m12), m13 = _mm256_set1_ps(mat.m13);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i);
+    _mm256_storeu_ps(outX + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, px), _mm256_mul_ps(m4, py)), m12));
+    _mm256_storeu_ps(outY + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m1, px), _mm256_mul_ps(m5, py)), m13));
+  }
+  BatchTransformScalar(x + i, y + i, outX + i, outY + i, count - i, mat);
+}
+
+SIMD_TARGET("avx2") static MARK_IGNORE_UNUSED_FUNC void BatchLengthAVX2(const float* x, const float* y, float* out, uint32_t count) {
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i);
+    _mm256_storeu_ps(out + i, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(py, py))));
+  }
+  BatchLengthScalar(x + i, y + i, out + i, count - i);
+}
+
+SIMD_TARGET("avx2") static MARK_IGNORE_UNUSED_FUNC void BatchDistanceAVX2(const float* ax, const float* ay, const float* bx, const float* by, float* out, uint32_t count) {
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(ax + i), _mm256_loadu_ps(bx + i));
+    __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ay + i), _mm256_loadu_ps(by + i));
+    _mm256_storeu_ps(out + i, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy))));
+  }
+  BatchDistanceScalar(ax + i, ay + i, bx + i, by + i, out + i, count - i);
+}
+
+SIMD_TARGET("avx2") static MARK_IGNORE_UNUSED_FUNC uint32_t BatchCheckCollisionPointRecAVX2(const float* x, const float* y, uint32_t count, Rectangle rec, uint8_t* outHits) {
+  __m256   minX = _mm256_set1_ps(rec.x), maxX = _mm256_set1_ps(rec.x + rec.width);
+  __m256   minY = _mm256_set1_ps(rec.y), maxY = _mm256_set1_ps(rec.y + rec.height);
+  uint32_t hits = 0, i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i);
+    __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(px, minX, _CMP_GE_OQ), _mm256_cmp_ps(px, maxX, _CMP_LT_OQ)),
+        _mm256_and_ps(_mm256_cmp_ps(py, minY, _CMP_GE_OQ), _mm256_cmp_ps(py, maxY, _CMP_LT_OQ)));
+    hits += StoreBatchHitMask(outHits + i, _mm256_movemask_ps(inside), 8);
+  }
+  return hits + BatchCheckCollisionPointRecScalar(x + i, y + i, count - i, rec, outHits + i);
+}
+
+SIMD_TARGET("avx2") static MARK_IGNORE_UNUSED_FUNC uint32_t BatchCheckCollisionRecsAVX2(const float* recX, const float* recY, const float* recW, const float* recH, uint32_t count, Rectangle rec, uint8_t* outHits) {
+  __m256   minX = _mm256_set1_ps(rec.x), maxX = _mm256_set1_ps(rec.x + rec.width);
+  __m256   minY = _mm256_set1_ps(rec.y), maxY = _mm256_set1_ps(rec.y + rec.height);
+  uint32_t hits = 0, i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 x = _mm256_loadu_ps(recX + i), y = _mm256_loadu_ps(recY + i);
+    __m256 itemMaxX = _mm256_add_ps(x, _mm256_loadu_ps(recW + i)), itemMaxY = _mm256_add_ps(y, _mm256_loadu_ps(recH + i));
+    __m256 overlap = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(x, maxX, _CMP_LT_OQ), _mm256_cmp_ps(itemMaxX, minX, _CMP_GT_OQ)),
+        _mm256_and_ps(_mm256_cmp_ps(y, maxY, _CMP_LT_OQ), _mm256_cmp_ps(itemMaxY, minY, _CMP_GT_OQ)));
+    hits += StoreBatchHitMask(outHits + i, _mm256_movemask_ps(overlap), 8);
+  }
+  return hits + BatchCheckCollisionRecsScalar(recX + i, recY + i, recW + i, recH + i, count - i, rec, outHits + i);
+}
+
+SIMD_TARGET("avx2") static MARK_IGNORE_UNUSED_FUNC void BatchLerpAVX2(const float* a, const float* b, float* out, uint32_t count, float amount) {
+  __m256   t = _mm256_set1_ps(amount);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 va = _mm256_loadu_ps(a + i);
+    _mm256_storeu_ps(out + i, _mm256_add_ps(va, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(b + i), va), t)));
+  }
+  BatchLerpScalar(a + i, b + i, out + i, count - i, amount);
+}
+#endif
+
+// ::RAYMATH BATCH API
+#if SIMD_X86
+#define BATCH_DISPATCH(name, ...)                                        \
+  switch (GetSimdLevel()) {                                              \
+  case SIMD_AVX2: return name##AVX2(__VA_ARGS__);                        \
+  case SIMD_SSE2: return name##SSE2(__VA_ARGS__);                        \
+  default: return name##Scalar(__VA_ARGS__);                             \
+  }
+// For void functions, returning a void expression isn't valid C.
+#define BATCH_DISPATCH_VOID(name, ...)                                   \
+  switch (GetSimdLevel()) {                                              \
+  case SIMD_AVX2: name##AVX2(__VA_ARGS__); return;                       \
+  case SIMD_SSE2: name##SSE2(__VA_ARGS__); return;                       \
+  default: name##Scalar(__VA_ARGS__); return;                            \
+  }
+#else
+#define BATCH_DISPATCH(name, ...) return name##Scalar(__VA_ARGS__);
+#define BATCH_DISPATCH_VOID(name, ...) name##Scalar(__VA_ARGS__);
+#endif
+
+// Vector2Transform over arrays. out may alias the input.
+static MARK_IGNORE_UNUSED_FUNC void BatchTransform(const float* x, const float* y, float* outX, float* outY, uint32_t count, Matrix mat) {
+  BATCH_DISPATCH_VOID(BatchTransform, x, y, outX, outY, count, mat)
+}
+
+// GetWorldToScreen2D over arrays.
+static MARK_IGNORE_UNUSED_FUNC void BatchWorldToScreen2D(const float* x, const float* y, float* outX, float* outY, uint32_t count, Camera2D camera) {
+  BatchTransform(x, y, outX, outY, count, GetCameraMatrix2D(camera));
+}
+
+// GetScreenToWorld2D over arrays.
+static MARK_IGNORE_UNUSED_FUNC void BatchScreenToWorld2D(const float* x, const float* y, float* outX, float* outY, uint32_t count, Camera2D camera) {
+  BatchTransform(x, y, outX, outY, count, MatrixInvert(GetCameraMatrix2D(camera)));
+}
+
+// Vector2Length over arrays.
+static MARK_IGNORE_UNUSED_FUNC void BatchLength(const float* x, const float* y, float* out, uint32_t count) {
+  BATCH_DISPATCH_VOID(BatchLength, x, y, out, count)
+}
+
+// Vector2Distance between a[i] and b[i].
+static MARK_IGNORE_UNUSED_FUNC void BatchDistance(const float* ax, const float* ay, const float* bx, const float* by, float* out, uint32_t count) {
+  BATCH_DISPATCH_VOID(BatchDistance, ax, ay, bx, by, out, count)
+}
+
+// CheckCollisionPointRec over arrays. outHits gets 0/1 per point, returns the number of hits.
+static MARK_IGNORE_UNUSED_FUNC uint32_t BatchCheckCollisionPointRec(const float* x, const float* y, uint32_t count, Rectangle rec, uint8_t* outHits) {
+  BATCH_DISPATCH(BatchCheckCollisionPointRec, x, y, count, rec, outHits)
+}
+
+// CheckCollisionRecs of every array rectangle against rec. outHits gets 0/1 per rectangle, returns the number of hits.
+static MARK_IGNORE_UNUSED_FUNC uint32_t BatchCheckCollisionRecs(const float* recX, const float* recY, const float* recW, const float* recH, uint32_t count, Rectangle rec, uint8_t* outHits) {
+  BATCH_DISPATCH(BatchCheckCollisionRecs, recX, recY, recW, recH, count, rec, outHits)
+}
+
+// Lerp per element. For Vector2 arrays call once per axis, or once over interleaved data with count * 2.
+static MARK_IGNORE_UNUSED_FUNC void BatchLerp(const float* a, const float* b, float* out, uint32_t count, float amount) {
+  BATCH_DISPATCH_VOID(BatchLerp, a, b, out, count, amount)
+}
+
+// ::RAYMATH BATCH SELF CHECK
+// Same idea as SimdKernelsSelfCheck: every compiled in vector path against the scalar one, raw
+// bits, and the same NOTE about the global level applies.
+#define BATCH_CHECK_COUNT 1027
+
+typedef struct RaymathBatchCheckOutput {
+  float    transformX[BATCH_CHECK_COUNT];
+  float    transformY[BATCH_CHECK_COUNT];
+  float    length[BATCH_CHECK_COUNT];
+  float    distance[BATCH_CHECK_COUNT];
+  float    lerp[BATCH_CHECK_COUNT];
+  uint8_t  pointHits[BATCH_CHECK_COUNT];
+  uint8_t  recHits[BATCH_CHECK_COUNT];
+  uint32_t pointHitCount;
+  uint32_t recHitCount;
+} RaymathBatchCheckOutput;
+
+static MARK_IGNORE_UNUSED_FUNC void RunRaymathBatchOps(float input[4][BATCH_CHECK_COUNT], uint32_t count, RaymathBatchCheckOutput* out) {
+  Camera2D  camera = {{400, 225}, {12.5f, -7.0f}, 30.0f, 1.75f};
+  Rectangle rec = {-200, -150, 300, 260};
+  memset(out, 0, sizeof(RaymathBatchCheckOutput));
+  BatchTransform(input[0], input[1], out->transformX, out->transformY, count, GetCameraMatrix2D(camera));
+  BatchLength(input[0], input[1], out->length, count);
+  BatchDistance(input[0], input[1], input[2], input[3], out->distance, count);
+  BatchLerp(input[0], input[1], out->lerp, count, 0.37f);
+  out->pointHitCount = BatchCheckCollisionPointRec(input[0], input[1], count, rec, out->pointHits);
+  out->recHitCount = BatchCheckCollisionRecs(input[0], input[1], input[2], input[3], count, rec, out->recHits);
+}
+
+static MARK_IGNORE_UNUSED_FUNC bool RaymathBatchSelfCheck() {
+  static float                   input[4][BATCH_CHECK_COUNT];
+  static RaymathBatchCheckOutput expected, actual;
+  uint32_t                       rng = 0x9E3779B9u;
+  for (int a = 0; a < 4; a++) {
+    for (int i = 0; i < BATCH_CHECK_COUNT; i++) {
+      rng = rng * 1664525u + 1013904223u;
+      input[a][i] = ((float)(rng >> 8) / (float)(1 << 24) - 0.5f) * 1000.0f;
+    }
+  }
+
+  SimdLevel savedLevel = GetSimdLevel();
+  SimdLevel supported = DetectSimdLevel();
+  bool      passed = true;
+  for (int level = SIMD_SSE2; level <= (int)SIMD_MAX_COMPILED_LEVEL; level++) {
+    if (level > (int)supported) {
+      TraceLog(LOG_INFO, "SIMD: raymath_batch %s path not checked, the CPU doesn't support it", SIMD_LEVEL_NAMES[level]);
+      continue;
+    }
+    bool matches = true;
+    for (uint32_t count = BATCH_CHECK_COUNT - 8; count <= BATCH_CHECK_COUNT && matches; count++) {
+      SetSimdLevel(SIMD_SCALAR);
+      RunRaymathBatchOps(input, count, &expected);
+      SetSimdLevel((SimdLevel)level);
+      RunRaymathBatchOps(input, count, &actual);
+      matches = memcmp(&expected, &actual, sizeof(RaymathBatchCheckOutput)) == 0;
+    }
+    if (!matches) {
+      TraceLog(LOG_ERROR, "SIMD: raymath_batch %s path does not match scalar", SIMD_LEVEL_NAMES[level]);
+      passed = false;
+    }
+  }
+  SetSimdLevel(savedLevel);
+  return passed;
+}
+
+#endif // !RAYMATH_BATCH_H
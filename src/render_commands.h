@@ -0,0 +1,369 @@
+#ifndef RENDER_COMMANDS_H
+#define RENDER_COMMANDS_H
+
+#include "include/raylib.h"
+#include "mem_arena.h"
+#include "render_stats.h"
+#include "sprite_batch.h"
+#include "utils.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+// ::RENDER COMMANDS
+// Systems push compact draw commands into a per-frame buffer instead of calling raylib inline.
+// Each command carries a 64 bit sort key, the buffer is radix sorted once and then replayed
+// against raylib on the main thread, so draw order comes from the key and not from code order.
+// Key layout, most significant first:
+//   layer   8 bits  RenderLayer, background to overlay
+//   phase   2 bits  camera begin, draws, camera end
+//   shader  6 bits  0 is raylib's default, see RegisterRenderShader
+//   texture 16 bits so sprites sharing a texture end up next to each other in one batch run
+//   depth   32 bits RenderDepthBits of a float, lowest first
+// Pushing reserves slots with one atomic add, so several jobs can fill the same buffer. The
+// order of commands with equal keys is push order within a thread, unspecified across threads.
+// Sorting and replaying must happen after every push is done.
+typedef enum RenderLayer {
+  RENDER_LAYER_BACKGROUND = 0,
+  RENDER_LAYER_WORLD,
+  RENDER_LAYER_UI,
+  RENDER_LAYER_OVERLAY,
+} RenderLayer;
+
+typedef enum RenderPhase {
+  RENDER_PHASE_BEGIN = 0,
+  RENDER_PHASE_DRAW,
+  RENDER_PHASE_END,
+} RenderPhase;
+
+typedef enum RenderCommandType {
+  RENDER_CMD_SPRITE = 0,
+  RENDER_CMD_TEXT,
+  RENDER_CMD_RECT,
+  RENDER_CMD_CAMERA_BEGIN,
+  RENDER_CMD_CAMERA_END,
+  RENDER_CMD_CALLBACK, // Escape hatch for drawing that isn't a command yet, runs on the main thread.
+  RENDER_CMD_LAYER,    // A cached layer's render texture, premultiplied, see layer_cache.h.
+} RenderCommandType;
+
+#define RENDER_KEY_LAYER_SHIFT   56
+#define RENDER_KEY_PHASE_SHIFT   54
+#define RENDER_KEY_SHADER_SHIFT  48
+#define RENDER_KEY_TEXTURE_SHIFT 32
+#define RENDER_MAX_SHADERS       64
+#define RENDER_TEXT_POOL_SIZE    (16 * 1024) // Default bytes of text per frame.
+// Texture key values for commands without a TextureID. Callbacks use 0 and go first.
+#define RENDER_TEXTURE_LAYERS 0xFFFD
+#define RENDER_TEXTURE_SHAPES 0xFFFE
+#define RENDER_TEXTURE_FONT   0xFFFF
+
+typedef void (*RenderCallbackFunc)(void* data);
+
+typedef struct RenderCommand {
+  RenderCommandType type;
+  union {
+    SpriteBatchItem sprite;
+    struct {
+      const char* text; // Copied into the buffer's text pool.
+      Vector2     position;
+      int         fontSize;
+      Color       color;
+    } text;
+    struct {
+      Rectangle rect;
+      Color     color;
+    } rect;
+    Camera2D camera;
+    struct {
+      RenderCallbackFunc func;
+      void*              data;
+    } callback;
+    struct {
+      Texture2D texture;
+      Vector2   position;
+    } layer;
+  };
+} RenderCommand;
+
+typedef struct RenderCommandBuffer {
+  uint32_t       capacity;
+  atomic_uint    count;
+  RenderCommand* commands;
+  uint64_t*      keys; // By command index while pushing, in sorted order after SortRenderCommands.
+  uint32_t*      order; // Command index of each sorted key.
+  uint64_t*      keysScratch;
+  uint32_t*      orderScratch;
+
+  uint32_t    textCapacity;
+  atomic_uint textUsed;
+  char*       text;
+
+  atomic_bool dropped; // A push didn't fit, something is missing from the frame.
+} RenderCommandBuffer;
+
+static Shader   renderShaders[RENDER_MAX_SHADERS];
+static uint32_t renderShaderCount = 1; // 0 means no shader mode.
+
+// Returns the id to put in MakeRenderKey, or 0 (default shader) when the table is full.
+static MARK_IGNORE_UNUSED_FUNC uint32_t RegisterRenderShader(Shader shader) {
+  if (renderShaderCount == RENDER_MAX_SHADERS) {
+    TraceLog(LOG_WARNING, "RENDER: Shader table full, using the default shader");
+    return 0;
+  }
+  renderShaders[renderShaderCount] = shader;
+  return renderShaderCount++;
+}
+
+// Maps a float to bits that sort in the same order as unsigned integers.
+static MARK_IGNORE_UNUSED_FUNC uint32_t RenderDepthBits(float depth) {
+  uint32_t bits;
+  memcpy(&bits, &depth, sizeof(bits));
+  return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+static MARK_IGNORE_UNUSED_FUNC uint64_t MakeRenderKey(RenderLayer layer, RenderPhase phase, uint32_t shader, uint32_t texture, float depth) {
+  return ((uint64_t)(layer & 0xFF) << RENDER_KEY_LAYER_SHIFT) |
+         ((uint64_t)(phase & 0x3) << RENDER_KEY_PHASE_SHIFT) |
+         ((uint64_t)(shader & (RENDER_MAX_SHADERS - 1)) << RENDER_KEY_SHADER_SHIFT) |
+         ((uint64_t)(texture & 0xFFFF) << RENDER_KEY_TEXTURE_SHIFT) |
+         RenderDepthBits(depth);
+}
+
+// For draws the caller already ordered, e.g. Y sorted sprites (y_sort.h). The sort is stable,
+// so commands sharing this key keep their push order. Reserve them as one block so other
+// threads can't interleave.
+static MARK_IGNORE_UNUSED_FUNC uint64_t MakeOrderedRenderKey(RenderLayer layer) {
+  return MakeRenderKey(layer, RENDER_PHASE_DRAW, 0, 0, 0);
+}
+
+static MARK_IGNORE_UNUSED_FUNC uint32_t RenderKeyShader(uint64_t key) {
+  return (uint32_t)(key >> RENDER_KEY_SHADER_SHIFT) & (RENDER_MAX_SHADERS - 1);
+}
+
+static MARK_IGNORE_UNUSED_FUNC size_t RenderCommandBufferArenaSize(uint32_t capacity, uint32_t textCapacity) {
+  return AlignUpMaxAlignment(sizeof(RenderCommandBuffer)) +
+         AlignUpMaxAlignment(sizeof(RenderCommand) * capacity) +
+         AlignUpMaxAlignment(sizeof(uint64_t) * capacity) * 2 +
+         AlignUpMaxAlignment(sizeof(uint32_t) * capacity) * 2 +
+         AlignUpMaxAlignment(textCapacity);
+}
+
+static MARK_IGNORE_UNUSED_FUNC RenderCommandBuffer* CreateRenderCommandBuffer(MemoryArena* arena, uint32_t capacity, uint32_t textCapacity) {
+  RenderCommandBuffer* buffer = PushType(arena, RenderCommandBuffer);
+  memset(buffer, 0, sizeof(RenderCommandBuffer));
+  buffer->capacity = capacity;
+  buffer->commands = PushArray(arena, capacity, RenderCommand);
+  buffer->keys = PushArray(arena, capacity, uint64_t);
+  buffer->order = PushArray(arena, capacity, uint32_t);
+  buffer->keysScratch = PushArray(arena, capacity, uint64_t);
+  buffer->orderScratch = PushArray(arena, capacity, uint32_t);
+  buffer->textCapacity = textCapacity;
+  buffer->text = PushArray(arena, textCapacity, char);
+  return buffer;
+}
+
+static MARK_IGNORE_UNUSED_FUNC uint32_t GetRenderCommandCount(RenderCommandBuffer* buffer) {
+  return atomic_load_explicit(&buffer->count, memory_order_relaxed);
+}
+
+// Reserves count consecutive slots and returns the first, or UINT32_MAX if they don't fit.
+// Thread safe. Fill the slots with WriteRenderCommand.
+static MARK_IGNORE_UNUSED_FUNC uint32_t ReserveRenderCommands(RenderCommandBuffer* buffer, uint32_t count) {
+  uint32_t first = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+  do {
+    if (count > buffer->capacity - first) { // A failed push must not leave unwritten slots counted.
+      atomic_store_explicit(&buffer->dropped, true, memory_order_relaxed);
+      return UINT32_MAX;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(&buffer->count, &first, first + count, memory_order_relaxed, memory_order_relaxed));
+  return first;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void WriteRenderCommand(RenderCommandBuffer* buffer, uint32_t index, uint64_t key, RenderCommand command) {
+  buffer->commands[index] = command;
+  buffer->keys[index] = key;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void PushRenderCommand(RenderCommandBuffer* buffer, uint64_t key, RenderCommand command) {
+  uint32_t index = ReserveRenderCommands(buffer, 1);
+  if (index != UINT32_MAX) WriteRenderCommand(buffer, index, key, command);
+}
+
+static MARK_IGNORE_UNUSED_FUNC void PushRenderSprite(RenderCommandBuffer* buffer, RenderLayer layer, float depth, SpriteBatchItem sprite) {
+  RenderCommand command = {.type = RENDER_CMD_SPRITE, .sprite = sprite};
+  PushRenderCommand(buffer, MakeRenderKey(layer, RENDER_PHASE_DRAW, 0, sprite.texture, depth), command);
+}
+
+// Reserves size bytes of the text pool like ReserveRenderCommands, UINT32_MAX if they don't fit.
+static MARK_IGNORE_UNUSED_FUNC uint32_t ReserveRenderText(RenderCommandBuffer* buffer, uint32_t size) {
+  uint32_t offset = atomic_load_explicit(&buffer->textUsed, memory_order_relaxed);
+  do {
+    if (size > buffer->textCapacity - offset) {
+      atomic_store_explicit(&buffer->dropped, true, memory_order_relaxed);
+      return UINT32_MAX;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(&buffer->textUsed, &offset, offset + size, memory_order_relaxed, memory_order_relaxed));
+  return offset;
+}
+
+// Same as DrawText. The string is copied, so TextFormat results are fine.
+static MARK_IGNORE_UNUSED_FUNC void PushRenderText(RenderCommandBuffer* buffer, RenderLayer layer, const char* text, int posX, int posY, int fontSize, Color color) {
+  uint32_t size = (uint32_t)strlen(text) + 1;
+  uint32_t offset = ReserveRenderText(buffer, size);
+  if (offset == UINT32_MAX) return;
+  uint32_t index = ReserveRenderCommands(buffer, 1);
+  if (index == UINT32_MAX) {
+    uint32_t end = offset + size; // Give the text back, unless another push has reserved after it since.
+    atomic_compare_exchange_strong_explicit(&buffer->textUsed, &end, offset, memory_order_relaxed, memory_order_relaxed);
+    return;
+  }
+  memcpy(buffer->text + offset, text, size);
+  RenderCommand command = {.type = RENDER_CMD_TEXT};
+  command.text.text = buffer->text + offset;
+  command.text.position = (Vector2){(float)posX, (float)posY};
+  command.text.fontSize = fontSize;
+  command.text.color = color;
+  WriteRenderCommand(buffer, index, MakeRenderKey(layer, RENDER_PHASE_DRAW, 0, RENDER_TEXTURE_FONT, 0), command);
+}
+
+static MARK_IGNORE_UNUSED_FUNC void PushRenderRect(RenderCommandBuffer* buffer, RenderLayer layer, float depth, Rectangle rect, Color color) {
+  RenderCommand command = {.type = RENDER_CMD_RECT};
+  command.rect.rect = rect;
+  command.rect.color = color;
+  PushRenderCommand(buffer, MakeRenderKey(layer, RENDER_PHASE_DRAW, 0, RENDER_TEXTURE_SHAPES, depth), command);
+}
+
+// Everything drawn in layer goes through camera. One camera per layer.
+static MARK_IGNORE_UNUSED_FUNC void PushRenderCamera(RenderCommandBuffer* buffer, RenderLayer layer, Camera2D camera) {
+  RenderCommand begin = {.type = RENDER_CMD_CAMERA_BEGIN, .camera = camera};
+  RenderCommand end = {.type = RENDER_CMD_CAMERA_END};
+  PushRenderCommand(buffer, MakeRenderKey(layer, RENDER_PHASE_BEGIN, 0, 0, 0), begin);
+  PushRenderCommand(buffer, MakeRenderKey(layer, RENDER_PHASE_END, 0, 0, 0), end);
+}
+
+static MARK_IGNORE_UNUSED_FUNC void PushRenderCallback(RenderCommandBuffer* buffer, RenderLayer layer, float depth, RenderCallbackFunc func, void* data) {
+  RenderCommand command = {.type = RENDER_CMD_CALLBACK};
+  command.callback.func = func;
+  command.callback.data = data;
+  PushRenderCommand(buffer, MakeRenderKey(layer, RENDER_PHASE_DRAW, 0, 0, depth), command);
+}
+
+// Stable LSD radix sort of the keys, 8 bits per pass, skipping bytes that are the same for every key.
+static MARK_IGNORE_UNUSED_FUNC void SortRenderCommands(RenderCommandBuffer* buffer) {
+  uint32_t count = GetRenderCommandCount(buffer);
+  uint32_t histograms[8][256];
+  memset(histograms, 0, sizeof(histograms));
+  for (uint32_t i = 0; i < count; i++) {
+    uint64_t key = buffer->keys[i];
+    buffer->order[i] = i;
+    for (int pass = 0; pass < 8; pass++) histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+  }
+
+  uint64_t* srcKeys = buffer->keys;
+  uint32_t* srcOrder = buffer->order;
+  uint64_t* dstKeys = buffer->keysScratch;
+  uint32_t* dstOrder = buffer->orderScratch;
+  for (int pass = 0; pass < 8; pass++) {
+    uint32_t* histogram = histograms[pass];
+    uint32_t  firstByte = count ? (buffer->keys[0] >> (pass * 8)) & 0xFF : 0;
+    if (histogram[firstByte] == count) continue;
+
+    uint32_t offset = 0;
+    for (int b = 0; b < 256; b++) {
+      uint32_t bucketSize = histogram[b];
+      histogram[b] = offset;
+      offset += bucketSize;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t slot = histogram[(srcKeys[i] >> (pass * 8)) & 0xFF]++;
+      dstKeys[slot] = srcKeys[i];
+      dstOrder[slot] = srcOrder[i];
+    }
+    uint64_t* swapKeys = srcKeys;
+    uint32_t* swapOrder = srcOrder;
+    srcKeys = dstKeys;
+    srcOrder = dstOrder;
+    dstKeys = swapKeys;
+    dstOrder = swapOrder;
+  }
+  if (srcKeys != buffer->keys) {
+    memcpy(buffer->keys, srcKeys, sizeof(uint64_t) * count);
+    memcpy(buffer->order, srcOrder, sizeof(uint32_t) * count);
+  }
+}
+
+// Quads DrawText emits for text, whitespace takes none.
+static MARK_IGNORE_UNUSED_FUNC uint32_t CountTextQuads(const char* text) {
+  uint32_t quads = 0;
+  for (const char* c = text; *c; c++) {
+    if (*c != ' ' && *c != '\t' && *c != '\n' && (*c & 0xC0) != 0x80) quads++; // UTF-8 continuation bytes belong to the previous glyph.
+  }
+  return quads;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void FlushRenderSprites(SpriteBatch* batch) {
+  if (batch->count == 0) return;
+  BuildSpriteBatchInOrder(batch);
+  SubmitSpriteBatch(batch);
+  BeginSpriteBatch(batch);
+}
+
+// Replays the sorted buffer against raylib. Consecutive sprites go through batch in key order.
+// NOTE: Call SortRenderCommands first. Main thread only, between BeginDrawing and EndDrawing.
+static MARK_IGNORE_UNUSED_FUNC void ExecuteRenderCommands(RenderCommandBuffer* buffer, SpriteBatch* batch) {
+  uint32_t count = GetRenderCommandCount(buffer);
+  uint32_t shader = 0;
+  BeginSpriteBatch(batch);
+  for (uint32_t i = 0; i < count; i++) {
+    const RenderCommand* command = &buffer->commands[buffer->order[i]];
+    uint32_t             commandShader = RenderKeyShader(buffer->keys[i]);
+    if (command->type != RENDER_CMD_SPRITE || commandShader != shader || batch->count == batch->capacity) FlushRenderSprites(batch);
+    if (commandShader != shader) {
+      RecordRenderFlush();
+      if (shader) EndShaderMode();
+      if (commandShader) BeginShaderMode(renderShaders[commandShader]);
+      shader = commandShader;
+    }
+
+    switch (command->type) {
+    case RENDER_CMD_SPRITE: batch->items[batch->count++] = command->sprite; break; // Room was made above.
+    case RENDER_CMD_TEXT:
+      DrawText(command->text.text, (int)command->text.position.x, (int)command->text.position.y, command->text.fontSize, command->text.color);
+      RecordRenderTexture(GetFontDefault().texture.id);
+      RecordRenderVertices(CountTextQuads(command->text.text) * 4);
+      break;
+    case RENDER_CMD_RECT:
+      DrawRectangleRec(command->rect.rect, command->rect.color);
+      RecordRenderTexture(GetShapesTexture().id);
+      RecordRenderVertices(4);
+      break;
+    case RENDER_CMD_CAMERA_BEGIN:
+      BeginMode2D(command->camera);
+      RecordRenderFlush();
+      break;
+    case RENDER_CMD_CAMERA_END:
+      EndMode2D();
+      RecordRenderFlush();
+      break;
+    case RENDER_CMD_CALLBACK: command->callback.func(command->callback.data); break;
+    case RENDER_CMD_LAYER: {
+      Texture2D texture = command->layer.texture;
+      BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+      DrawTextureRec(texture, (Rectangle){0, 0, texture.width, -texture.height}, command->layer.position, WHITE); // Render textures are stored upside down.
+      EndBlendMode();
+      RecordRenderFlush(); // Blend mode switch.
+      RecordRenderTexture(texture.id);
+      RecordRenderVertices(4);
+      RecordRenderFlush();
+    } break;
+    }
+  }
+  FlushRenderSprites(batch);
+  if (shader) {
+    EndShaderMode();
+    RecordRenderFlush();
+  }
+  renderStats.commands += count;
+}
+
+#endif // !RENDER_COMMANDS_H
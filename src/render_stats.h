@@ -0,0 +1,86 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include "include/rlgl.h"
+#include "utils.h"
+#include <stdint.h>
+#include <string.h>
+
+// ::RENDER STATS
+// GPU side cost of a frame: draw calls, rlgl batch flushes, vertices and texture switches.
+// rlgl keeps its batch state private, so the renderer reports what it hands over and the
+// counters replay rlgl's default batch rules on top of that:
+// - A texture change ends the current draw call, if it has vertices.
+// - The batch is flushed when its vertex buffer or its draw call list is full, and on every
+//   mode change (camera, blend mode, shader, render texture, EndDrawing).
+// Draws that go straight to raylib without a Record call aren't seen, so the numbers are a floor.
+// NOTE: Main thread only, like the rlgl calls it shadows.
+#define RENDER_STATS_BATCH_VERTICES (RL_DEFAULT_BATCH_BUFFER_ELEMENTS * 4)
+
+typedef struct RenderStats {
+  uint32_t drawCalls;
+  uint32_t batchFlushes;
+  uint32_t vertices;
+  uint32_t textureSwitches;
+  uint32_t spritesDrawn;
+  uint32_t spritesCulled;
+  uint32_t commands;
+  uint32_t layerRedraws;
+
+  // rlgl's current batch, as far as we can tell.
+  uint32_t boundTexture; // 0 after a flush, rlgl rebinds its default texture.
+  uint32_t batchVertices;
+  uint32_t batchDraws; // Finished draw calls in the batch, not counting the open one.
+  uint32_t drawVertices; // In the open draw call.
+} RenderStats;
+
+// Counters for the frame being drawn. The last finished frame is kept by whoever calls EndRenderStats.
+RenderStats renderStats = {0};
+
+static MARK_IGNORE_UNUSED_FUNC void BeginRenderStats(void) { memset(&renderStats, 0, sizeof(RenderStats)); }
+
+static MARK_IGNORE_UNUSED_FUNC void RecordRenderFlush(void) {
+  RenderStats* stats = &renderStats;
+  if (stats->batchVertices > 0) {
+    stats->batchFlushes++;
+    stats->drawCalls += stats->batchDraws + (stats->drawVertices > 0);
+  }
+  stats->boundTexture = 0;
+  stats->batchVertices = 0;
+  stats->batchDraws = 0;
+  stats->drawVertices = 0;
+}
+
+// Same as rlSetTexture: 0 keeps whatever is bound.
+static MARK_IGNORE_UNUSED_FUNC void RecordRenderTexture(uint32_t textureId) {
+  RenderStats* stats = &renderStats;
+  if (textureId == 0 || textureId == stats->boundTexture) return;
+  stats->textureSwitches++;
+  if (stats->drawVertices > 0) {
+    stats->batchDraws++;
+    stats->drawVertices = 0;
+    if (stats->batchDraws + 1 >= RL_DEFAULT_BATCH_DRAWCALLS) RecordRenderFlush();
+  }
+  stats->boundTexture = textureId;
+}
+
+// Same as rlCheckRenderBatchLimit followed by the vertices: a full batch is flushed first, the texture stays bound.
+static MARK_IGNORE_UNUSED_FUNC void RecordRenderVertices(uint32_t count) {
+  RenderStats* stats = &renderStats;
+  if (stats->batchVertices + count >= RENDER_STATS_BATCH_VERTICES) {
+    uint32_t texture = stats->boundTexture;
+    RecordRenderFlush();
+    stats->boundTexture = texture;
+  }
+  stats->batchVertices += count;
+  stats->drawVertices += count;
+  stats->vertices += count;
+}
+
+// Closes the frame after EndDrawing and returns its counters.
+static MARK_IGNORE_UNUSED_FUNC RenderStats EndRenderStats(void) {
+  RecordRenderFlush(); // EndDrawing's.
+  return renderStats;
+}
+
+#endif // !RENDER_STATS_H
@@ -0,0 +1,246 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include "include/raylib.h"
+#include "utils.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+// ::SIMD KERNELS
+// Movement kernels over plain float arrays: SSE2 and AVX2 on x86, scalar everywhere else.
+// The level is picked once at runtime from what the CPU supports, so one binary runs
+// everywhere. Every path does the exact same float operations in the same order (no FMA),
+// so results are bit-for-bit identical whichever path runs, see SimdKernelsSelfCheck.
+// Arrays only need float alignment. Works on SoA arrays (call once for x, once for y) or
+// on interleaved Vector2 arrays with count * 2.
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_X86 0
+#endif
+#define SIMD_MAX_COMPILED_LEVEL (SIMD_X86 ? SIMD_AVX2 : SIMD_SCALAR) // Highest path built into this binary.
+
+typedef enum SimdLevel {
+  SIMD_SCALAR = 0,
+  SIMD_SSE2,
+  SIMD_AVX2,
+
+  SIMD_LEVEL_COUNT
+} SimdLevel;
+
+static const char* SIMD_LEVEL_NAMES[SIMD_LEVEL_COUNT] = {"scalar", "sse2", "avx2"};
+
+static atomic_int simdLevel = -1; // SimdLevel, -1 until detected. Kernels run on job threads, any of them can detect it first.
+
+static MARK_IGNORE_UNUSED_FUNC SimdLevel DetectSimdLevel() {
+#if SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+  if (__builtin_cpu_supports("sse2")) return SIMD_SSE2;
+#endif
+  return SIMD_SCALAR;
+}
+
+static MARK_IGNORE_UNUSED_FUNC SimdLevel GetSimdLevel() {
+  int level = atomic_load_explicit(&simdLevel, memory_order_relaxed);
+  if (level < 0) {
+    int detected = DetectSimdLevel();
+    level = -1;
+    if (atomic_compare_exchange_strong(&simdLevel, &level, detected)) level = detected; // Else level is what got there first.
+  }
+  return (SimdLevel)level;
+}
+
+// Forces a lower level, e.g. to compare paths. Can't go above what the CPU supports.
+static MARK_IGNORE_UNUSED_FUNC void SetSimdLevel(SimdLevel level) {
+  SimdLevel supported = DetectSimdLevel();
+  atomic_store_explicit(&simdLevel, level < supported ? level : supported, memory_order_relaxed);
+}
+
+// ::SIMD KERNELS SCALAR
+// Also the tail of the vector paths, and the reference they are checked against.
+static MARK_IGNORE_UNUSED_FUNC void SimdIntegrateScalar(float* restrict pos, const float* restrict vel, uint32_t count, float deltaTime) {
+  for (uint32_t i = 0; i < count; i++) {
+    float step = vel[i] * deltaTime; // Own statement so clang's default fp-contract can't fuse it.
+    pos[i] = pos[i] + step;
+  }
+}
+
+static MARK_IGNORE_UNUSED_FUNC void SimdClampScalar(float* values, uint32_t count, float min, float max) {
+  for (uint32_t i = 0; i < count; i++) {
+    float v = values[i] < max ? values[i] : max; // Same operand order as minps/maxps.
+    values[i] = v > min ? v : min;
+  }
+}
+
+static MARK_IGNORE_UNUSED_FUNC void SimdScaleScalar(float* values, uint32_t count, float scale) {
+  for (uint32_t i = 0; i < count; i++) values[i] = values[i] * scale;
+}
+
+#if SIMD_X86
+// ::SIMD KERNELS SSE2
+SIMD_TARGET("sse2") static MARK_IGNORE_UNUSED_FUNC void SimdIntegrateSSE2(float* restrict pos, const float* restrict vel, uint32_t count, float deltaTime) {
+  __m128   dt = _mm_set1_ps(deltaTime);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 step = _mm_mul_ps(_mm_loadu_ps(vel + i), dt);
+    _mm_storeu_ps(pos + i, _mm_add_ps(_mm_loadu_ps(pos + i), step));
+  }
+  SimdIntegrateScalar(pos + i, vel + i, count - i, deltaTime);
+}
+
+SIMD_TARGET("sse2") static MARK_IGNORE_UNUSED_FUNC void SimdClampSSE2(float* values, uint32_t count, float min, float max) {
+  __m128   lo = _mm_set1_ps(min), hi = _mm_set1_ps(max);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 v = _mm_min_ps(_mm_loadu_ps(values + i), hi);
+    _mm_storeu_ps(values + i, _mm_max_ps(v, lo));
+  }
+  SimdClampScalar(values + i, count - i, min, max);
+}
+
+SIMD_TARGET("sse2") static MARK_IGNORE_UNUSED_FUNC void SimdScaleSSE2(float* values, uint32_t count, float scale) {
+  __m128   s = _mm_set1_ps(scale);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4) _mm_storeu_ps(values + i, _mm_mul_ps(_mm_loadu_ps(values + i), s));
+  SimdScaleScalar(values + i, count - i, scale);
+}
+
+// ::SIMD KERNELS AVX2
+// NOTE: Only "avx2", not "fma". Letting the compiler fuse mul + add would change the rounding.
+SIMD_TARGET("avx2") static MARK_IGNORE_UNUSED_FUNC void SimdIntegrateAVX2(float* restrict pos, const float* restrict vel, uint32_t count, float deltaTime) {
+  __m256   dt = _mm256_set1_ps(deltaTime);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 step = _mm256_mul_ps(_mm256_loadu_ps(vel + i), dt);
+    _mm256_storeu_ps(pos + i, _mm256_add_ps(_mm256_loadu_ps(pos + i), step));
+  }
+  SimdIntegrateScalar(pos + i, vel + i, count - i, deltaTime);
+}
+
+SIMD_TARGET("avx2") static MARK_IGNORE_UNUSED_FUNC void SimdClampAVX2(float* values, uint32_t count, float min, float max) {
+  __m256   lo = _mm256_set1_ps(min), hi = _mm256_set1_ps(max);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 v = _mm256_min_ps(_mm256_loadu_ps(values + i), hi);
+    _mm256_storeu_ps(values + i, _mm256_max_ps(v, lo));
+  }
+  SimdClampScalar(values + i, count - i, min, max);
+}
+
+SIMD_TARGET("avx2") static MARK_IGNORE_UNUSED_FUNC void SimdScaleAVX2(float* values, uint32_t count, float scale) {
+  __m256   s = _mm256_set1_ps(scale);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8) _mm256_storeu_ps(values + i, _mm256_mul_ps(_mm256_loadu_ps(values + i), s));
+  SimdScaleScalar(values + i, count - i, scale);
+}
+#endif
+
+// ::SIMD KERNELS API
+// pos += vel * deltaTime
+static MARK_IGNORE_UNUSED_FUNC void SimdIntegrate(float* restrict pos, const float* restrict vel, uint32_t count, float deltaTime) {
+#if SIMD_X86
+  switch (GetSimdLevel()) {
+  case SIMD_AVX2: SimdIntegrateAVX2(pos, vel, count, deltaTime); return;
+  case SIMD_SSE2: SimdIntegrateSSE2(pos, vel, count, deltaTime); return;
+  default: break;
+  }
+#endif
+  SimdIntegrateScalar(pos, vel, count, deltaTime);
+}
+
+static MARK_IGNORE_UNUSED_FUNC void SimdClamp(float* values, uint32_t count, float min, float max) {
+#if SIMD_X86
+  switch (GetSimdLevel()) {
+  case SIMD_AVX2: SimdClampAVX2(values, count, min, max); return;
+  case SIMD_SSE2: SimdClampSSE2(values, count, min, max); return;
+  default: break;
+  }
+#endif
+  SimdClampScalar(values, count, min, max);
+}
+
+static MARK_IGNORE_UNUSED_FUNC void SimdScale(float* values, uint32_t count, float scale) {
+#if SIMD_X86
+  switch (GetSimdLevel()) {
+  case SIMD_AVX2: SimdScaleAVX2(values, count, scale); return;
+  case SIMD_SSE2: SimdScaleSSE2(values, count, scale); return;
+  default: break;
+  }
+#endif
+  SimdScaleScalar(values, count, scale);
+}
+
+static MARK_IGNORE_UNUSED_FUNC void SimdClampToBounds(float* posX, float* posY, uint32_t count, Rectangle bounds) {
+  SimdClamp(posX, count, bounds.x, bounds.x + bounds.width);
+  SimdClamp(posY, count, bounds.y, bounds.y + bounds.height);
+}
+
+// Linear drag, damping is the fraction of velocity lost per second.
+static MARK_IGNORE_UNUSED_FUNC void SimdApplyDamping(float* velX, float* velY, uint32_t count, float damping, float deltaTime) {
+  float scale = 1.0f - damping * deltaTime;
+  if (scale < 0) scale = 0;
+  SimdScale(velX, count, scale);
+  SimdScale(velY, count, scale);
+}
+
+// ::SIMD KERNELS SELF CHECK
+// Runs every compiled in vector path against the scalar reference on the same random input and
+// compares the raw bits, whichever level is selected. Paths the CPU can't run are logged as
+// unchecked. Odd counts so the scalar tails are covered too.
+// NOTE: Switches the global level while it runs, so call it before kernels run anywhere else.
+#define SIMD_CHECK_COUNT 1027
+
+static MARK_IGNORE_UNUSED_FUNC bool SimdKernelsSelfCheck() {
+  static float input[SIMD_CHECK_COUNT], vel[SIMD_CHECK_COUNT], expected[SIMD_CHECK_COUNT], actual[SIMD_CHECK_COUNT];
+  uint32_t     rng = 0x12345678u;
+  for (int i = 0; i < SIMD_CHECK_COUNT; i++) {
+    rng = rng * 1664525u + 1013904223u;
+    input[i] = ((float)(rng >> 8) / (float)(1 << 24) - 0.5f) * 2000.0f;
+    rng = rng * 1664525u + 1013904223u;
+    vel[i] = ((float)(rng >> 8) / (float)(1 << 24) - 0.5f) * 600.0f;
+  }
+
+  SimdLevel savedLevel = GetSimdLevel();
+  SimdLevel supported = DetectSimdLevel();
+  bool      passed = true;
+  for (int level = SIMD_SSE2; level <= (int)SIMD_MAX_COMPILED_LEVEL; level++) {
+    if (level > (int)supported) {
+      TraceLog(LOG_INFO, "SIMD: %s kernels not checked, the CPU doesn't support them", SIMD_LEVEL_NAMES[level]);
+      continue;
+    }
+    const char* failed = 0;
+    for (uint32_t count = SIMD_CHECK_COUNT - 8; count <= SIMD_CHECK_COUNT && !failed; count++) {
+      SetSimdLevel(SIMD_SCALAR);
+      memcpy(expected, input, sizeof(input));
+      SimdIntegrate(expected, vel, count, 1.0f / 60.0f);
+      SetSimdLevel((SimdLevel)level);
+      memcpy(actual, input, sizeof(input));
+      SimdIntegrate(actual, vel, count, 1.0f / 60.0f);
+      if (memcmp(expected, actual, sizeof(input)) != 0) failed = "SimdIntegrate";
+
+      SetSimdLevel(SIMD_SCALAR);
+      SimdClamp(expected, count, -400.0f, 400.0f);
+      SetSimdLevel((SimdLevel)level);
+      SimdClamp(actual, count, -400.0f, 400.0f);
+      if (!failed && memcmp(expected, actual, sizeof(input)) != 0) failed = "SimdClamp";
+
+      SetSimdLevel(SIMD_SCALAR);
+      SimdScale(expected, count, 0.987f);
+      SetSimdLevel((SimdLevel)level);
+      SimdScale(actual, count, 0.987f);
+      if (!failed && memcmp(expected, actual, sizeof(input)) != 0) failed = "SimdScale";
+    }
+    if (failed) {
+      TraceLog(LOG_ERROR, "SIMD: %s %s path does not match scalar", failed, SIMD_LEVEL_NAMES[level]);
+      passed = false;
+    }
+  }
+  SetSimdLevel(savedLevel);
+  return passed;
+}
+
+#endif // !SIMD_KERNELS_H
@@ -0,0 +1,213 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "include/raylib.h"
+#include "mem_arena.h"
+#include "utils.h"
+#include <math.h>
+#include <stdint.h>
+
+// ::SPATIAL GRID
+// Spatial hash broadphase. Rebuilt from scratch every tick into the frame arena with a counting
+// sort, so building is O(n + buckets) and nothing needs freeing. Every item is a circle
+// (position + radius) binned by its centre cell. Queries and pair generation widen their search
+// by the largest radius in the grid, so keep cellSize at roughly 2x the typical radius and avoid
+// a few huge items mixed with many small ones.
+typedef struct SpatialPair {
+  uint32_t a; // Always a < b.
+  uint32_t b;
+} SpatialPair;
+
+typedef struct SpatialGrid {
+  float    cellSize;
+  float    invCellSize;
+  float    maxRadius;
+  uint32_t bucketMask;
+  uint32_t itemCount;
+
+  uint32_t* bucketStart; // [bucketMask + 2], items of bucket b are sortedItems[bucketStart[b] .. bucketStart[b + 1])
+  uint32_t* sortedItems;
+
+  // Per item, indexed by the caller's item index.
+  float*   posX;
+  float*   posY;
+  float*   radius;
+  int32_t* cellX;
+  int32_t* cellY;
+} SpatialGrid;
+
+static MARK_IGNORE_UNUSED_FUNC uint32_t HashGridCell(int32_t cellX, int32_t cellY, uint32_t bucketMask) {
+  return (((uint32_t)cellX * 73856093u) ^ ((uint32_t)cellY * 19349663u)) & bucketMask;
+}
+
+static MARK_IGNORE_UNUSED_FUNC int32_t GridCellCoord(const SpatialGrid* grid, float value) {
+  return (int32_t)floorf(value * grid->invCellSize);
+}
+
+// ~2 buckets per item keeps unrelated cells sharing a bucket rare.
+static MARK_IGNORE_UNUSED_FUNC uint32_t SpatialGridBucketCount(uint32_t count) {
+  uint32_t bucketCount = 16;
+  while (bucketCount < count * 2) bucketCount <<= 1;
+  return bucketCount;
+}
+
+// What BuildSpatialGrid pushes for count items, pairs not included.
+static MARK_IGNORE_UNUSED_FUNC size_t SpatialGridArenaSize(uint32_t count) {
+  size_t bucketCount = SpatialGridBucketCount(count);
+  return AlignUpMaxAlignment(sizeof(SpatialGrid)) +
+         AlignUpMaxAlignment(sizeof(uint32_t) * (bucketCount + 1)) + // bucketStart
+         AlignUpMaxAlignment(sizeof(uint32_t) * bucketCount) +       // writeCursor
+         AlignUpMaxAlignment(sizeof(uint32_t) * count) * 2 +         // sortedItems, itemBucket
+         AlignUpMaxAlignment(sizeof(float) * count) * 3 +
+         AlignUpMaxAlignment(sizeof(int32_t) * count) * 2;
+}
+
+// radius may be NULL, in which case every item uses defaultRadius.
+static MARK_IGNORE_UNUSED_FUNC SpatialGrid* BuildSpatialGrid(MemoryArena* frameArena,
+    const float*                                                          posX,
+    const float*                                                          posY,
+    const float*                                                          radius,
+    float                                                                 defaultRadius,
+    uint32_t                                                              count,
+    float                                                                 cellSize) {
+  assert(cellSize > 0);
+  SpatialGrid* grid = PushType(frameArena, SpatialGrid);
+  grid->cellSize = cellSize;
+  grid->invCellSize = 1.0f / cellSize;
+  grid->itemCount = count;
+
+  uint32_t bucketCount = SpatialGridBucketCount(count);
+  grid->bucketMask = bucketCount - 1;
+
+  grid->bucketStart = PushArray(frameArena, bucketCount + 1, uint32_t);
+  grid->sortedItems = PushArray(frameArena, count, uint32_t);
+  grid->posX = PushArray(frameArena, count, float);
+  grid->posY = PushArray(frameArena, count, float);
+  grid->radius = PushArray(frameArena, count, float);
+  grid->cellX = PushArray(frameArena, count, int32_t);
+  grid->cellY = PushArray(frameArena, count, int32_t);
+  uint32_t* itemBucket = PushArray(frameArena, count, uint32_t);
+  memset(grid->bucketStart, 0, sizeof(uint32_t) * (bucketCount + 1));
+
+  float maxRadius = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    float r = radius ? radius[i] : defaultRadius;
+    grid->posX[i] = posX[i];
+    grid->posY[i] = posY[i];
+    grid->radius[i] = r;
+    if (r > maxRadius) maxRadius = r;
+
+    grid->cellX[i] = GridCellCoord(grid, posX[i]);
+    grid->cellY[i] = GridCellCoord(grid, posY[i]);
+    itemBucket[i] = HashGridCell(grid->cellX[i], grid->cellY[i], grid->bucketMask);
+    grid->bucketStart[itemBucket[i] + 1]++;
+  }
+  grid->maxRadius = maxRadius;
+
+  // Counting sort: prefix sum the bucket sizes, then scatter.
+  for (uint32_t b = 0; b < bucketCount; b++) grid->bucketStart[b + 1] += grid->bucketStart[b];
+  uint32_t* writeCursor = PushArray(frameArena, bucketCount, uint32_t);
+  memcpy(writeCursor, grid->bucketStart, sizeof(uint32_t) * bucketCount);
+  for (uint32_t i = 0; i < count; i++) grid->sortedItems[writeCursor[itemBucket[i]]++] = i;
+
+  return grid;
+}
+
+static MARK_IGNORE_UNUSED_FUNC bool GridItemOverlapsAABB(const SpatialGrid* grid, uint32_t item, Rectangle rect) {
+  float r = grid->radius[item];
+  return grid->posX[item] + r >= rect.x && grid->posX[item] - r <= rect.x + rect.width &&
+         grid->posY[item] + r >= rect.y && grid->posY[item] - r <= rect.y + rect.height;
+}
+
+// Calls back for every item whose centre cell lies in the cell range. Each item is visited once,
+// even when several cells in the range share a bucket.
+#define SPATIAL_GRID_FOR_CELL_RANGE(grid, minCellX, minCellY, maxCellX, maxCellY, itemVar, ...) \
+  for (int32_t cy_ = (minCellY); cy_ <= (maxCellY); cy_++) {                                       \
+    for (int32_t cx_ = (minCellX); cx_ <= (maxCellX); cx_++) {                                     \
+      uint32_t bucket_ = HashGridCell(cx_, cy_, (grid)->bucketMask);                               \
+      for (uint32_t k_ = (grid)->bucketStart[bucket_]; k_ < (grid)->bucketStart[bucket_ + 1]; k_++) { \
+        uint32_t itemVar = (grid)->sortedItems[k_];                                                \
+        if ((grid)->cellX[itemVar] != cx_ || (grid)->cellY[itemVar] != cy_) continue;              \
+        __VA_ARGS__                                                                                \
+      }                                                                                            \
+    }                                                                                              \
+  }
+
+// Writes the indices of every item overlapping rect into an arena array. Returns the count.
+static MARK_IGNORE_UNUSED_FUNC uint32_t QuerySpatialGridAABB(const SpatialGrid* grid, Rectangle rect, MemoryArena* arena, uint32_t** outItems) {
+  float    pad = grid->maxRadius;
+  int32_t  minCellX = GridCellCoord(grid, rect.x - pad), maxCellX = GridCellCoord(grid, rect.x + rect.width + pad);
+  int32_t  minCellY = GridCellCoord(grid, rect.y - pad), maxCellY = GridCellCoord(grid, rect.y + rect.height + pad);
+  uint32_t maxResults = grid->itemCount;
+  uint32_t found = 0;
+  uint32_t* results = PushArray(arena, maxResults, uint32_t);
+
+  SPATIAL_GRID_FOR_CELL_RANGE(grid, minCellX, minCellY, maxCellX, maxCellY, item, {
+    if (GridItemOverlapsAABB(grid, item, rect)) results[found++] = item;
+  })
+
+  ShrinkLastPush(arena, results, sizeof(uint32_t) * found);
+  *outItems = results;
+  return found;
+}
+
+// Writes the indices of every item whose circle overlaps the query circle. Returns the count.
+static MARK_IGNORE_UNUSED_FUNC uint32_t QuerySpatialGridRadius(const SpatialGrid* grid, Vector2 center, float radius, MemoryArena* arena, uint32_t** outItems) {
+  float    pad = radius + grid->maxRadius;
+  int32_t  minCellX = GridCellCoord(grid, center.x - pad), maxCellX = GridCellCoord(grid, center.x + pad);
+  int32_t  minCellY = GridCellCoord(grid, center.y - pad), maxCellY = GridCellCoord(grid, center.y + pad);
+  uint32_t found = 0;
+  uint32_t* results = PushArray(arena, grid->itemCount, uint32_t);
+
+  SPATIAL_GRID_FOR_CELL_RANGE(grid, minCellX, minCellY, maxCellX, maxCellY, item, {
+    float dx = grid->posX[item] - center.x;
+    float dy = grid->posY[item] - center.y;
+    float reach = radius + grid->radius[item];
+    if (dx * dx + dy * dy <= reach * reach) results[found++] = item;
+  })
+
+  ShrinkLastPush(arena, results, sizeof(uint32_t) * found);
+  *outItems = results;
+  return found;
+}
+
+typedef struct SpatialPairs {
+  SpatialPair* pairs;
+  uint32_t     count;
+  bool         truncated; // Ran out of arena space, some pairs are missing.
+} SpatialPairs;
+
+// Every pair of overlapping circles, each pair once with a < b. Uses the rest of the arena as
+// the output buffer and gives back what it did not use.
+static MARK_IGNORE_UNUSED_FUNC SpatialPairs FindOverlappingPairs(const SpatialGrid* grid, MemoryArena* arena) {
+  SpatialPairs result = {0};
+  size_t       available = arena->size - AlignUpMaxAlignment(arena->used);
+  uint32_t     maxPairs = (uint32_t)(available / sizeof(SpatialPair));
+  result.pairs = PushArray(arena, maxPairs, SpatialPair);
+
+  // Walk items in bucket order so neighbouring items are also neighbours in memory.
+  for (uint32_t k = 0; k < grid->itemCount && !result.truncated; k++) {
+    uint32_t a = grid->sortedItems[k];
+    float    ax = grid->posX[a], ay = grid->posY[a], ar = grid->radius[a];
+    float    reach = ar + grid->maxRadius; // Centres further than this can't touch a.
+    int32_t  minCellX = GridCellCoord(grid, ax - reach), maxCellX = GridCellCoord(grid, ax + reach);
+    int32_t  minCellY = GridCellCoord(grid, ay - reach), maxCellY = GridCellCoord(grid, ay + reach);
+    SPATIAL_GRID_FOR_CELL_RANGE(grid, minCellX, minCellY, maxCellX, maxCellY, b, {
+      if (b <= a) continue;
+      float dx = grid->posX[b] - ax;
+      float dy = grid->posY[b] - ay;
+      float touch = ar + grid->radius[b];
+      if (dx * dx + dy * dy > touch * touch) continue;
+      if (result.count == maxPairs) {
+        result.truncated = true;
+        break;
+      }
+      result.pairs[result.count++] = (SpatialPair){a, b};
+    })
+  }
+
+  ShrinkLastPush(arena, result.pairs, sizeof(SpatialPair) * result.count);
+  return result;
+}
+
+#endif // !SPATIAL_GRID_H
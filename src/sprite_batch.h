@@ -0,0 +1,308 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include "include/raylib.h"
+#include "include/rlgl.h"
+#include "game_defines.h"
+#include "mem_arena.h"
+#include "render_stats.h"
+#include "texture_cache.h"
+#include "utils.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// ::SPRITE BATCH
+// Collects sprites for the frame, sorts them by texture (stable, so submission order is kept
+// within a texture) and expands them into a quad vertex stream in one tight loop: UVs, rotation
+// and flips are worked out here once instead of per DrawTexturePro call. Building touches no
+// raylib state, so it runs on any thread and headless; SubmitSpriteBatch then feeds the stream
+// to rlgl with one rlSetTexture per texture run.
+// NOTE: rlgl doesn't expose its vertex buffers for direct writes, so submission goes through
+// rlTexCoord2f/rlVertex2f, which are plain stores into the current batch buffer.
+#define SPRITE_BATCH_SUBMIT_CHUNK 1024 // Quads per rlCheckRenderBatchLimit, well under RL_DEFAULT_BATCH_BUFFER_ELEMENTS.
+
+typedef struct SpriteBatchItem {
+  TextureID texture;
+  Rectangle source;
+  Rectangle dest;
+  Vector2   origin;
+  float     rotation;
+  Color     tint;
+} SpriteBatchItem;
+
+// Quad corners in DrawTexturePro order: top left, bottom left, bottom right, top right.
+typedef struct SpriteVertex {
+  float x, y;
+  float u, v;
+  Color color;
+} SpriteVertex;
+
+typedef struct SpriteBatchRun {
+  TextureID texture;
+  uint32_t  firstQuad;
+  uint32_t  quadCount;
+} SpriteBatchRun;
+
+typedef struct SpriteBatch {
+  uint32_t         capacity;
+  uint32_t         count;
+  SpriteBatchItem* items;
+
+  // Filled by BuildSpriteBatch.
+  uint32_t*       order; // Item indices sorted by texture.
+  uint32_t*       orderScratch;
+  SpriteVertex*   vertices; // 4 per quad
+  SpriteBatchRun* runs;
+  uint32_t        runCount;
+  bool            dropped; // Pushed past capacity, some sprites are missing.
+} SpriteBatch;
+
+static MARK_IGNORE_UNUSED_FUNC size_t SpriteBatchArenaSize(uint32_t capacity) {
+  return AlignUpMaxAlignment(sizeof(SpriteBatch)) +
+         AlignUpMaxAlignment(sizeof(SpriteBatchItem) * capacity) +
+         AlignUpMaxAlignment(sizeof(uint32_t) * capacity) * 2 +
+         AlignUpMaxAlignment(sizeof(SpriteVertex) * 4 * capacity) +
+         AlignUpMaxAlignment(sizeof(SpriteBatchRun) * capacity);
+}
+
+static MARK_IGNORE_UNUSED_FUNC SpriteBatch* CreateSpriteBatch(MemoryArena* arena, uint32_t capacity) {
+  SpriteBatch* batch = PushType(arena, SpriteBatch);
+  memset(batch, 0, sizeof(SpriteBatch));
+  batch->capacity = capacity;
+  batch->items = PushArray(arena, capacity, SpriteBatchItem);
+  batch->order = PushArray(arena, capacity, uint32_t);
+  batch->orderScratch = PushArray(arena, capacity, uint32_t);
+  batch->vertices = PushArray(arena, capacity * 4, SpriteVertex);
+  batch->runs = PushArray(arena, capacity, SpriteBatchRun);
+  return batch;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void BeginSpriteBatch(SpriteBatch* batch) {
+  batch->count = 0;
+  batch->runCount = 0;
+  batch->dropped = false;
+}
+
+// Same arguments as DrawTexturePro, with the texture given by id.
+static MARK_IGNORE_UNUSED_FUNC void PushSpriteBatchItem(SpriteBatch* batch, TextureID texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) {
+  if (batch->count == batch->capacity) {
+    batch->dropped = true;
+    return;
+  }
+  batch->items[batch->count++] = (SpriteBatchItem){texture, source, dest, origin, rotation, tint};
+}
+
+// Sprite centred on pos, at its atlas size.
+static MARK_IGNORE_UNUSED_FUNC void PushSprite(SpriteBatch* batch, SpriteID spriteID, Vector2 pos, Color tint) {
+  SpriteData spriteData = sprites[spriteID];
+  Rectangle  dest = (Rectangle){
+      pos.x - (spriteData.size.x / 2),
+      pos.y - (spriteData.size.y / 2),
+      spriteData.size.x,
+      spriteData.size.y,
+  };
+  PushSpriteBatchItem(batch, spriteData.sourceTexture, spriteData.sourceRect, dest, (Vector2){0, 0}, 0, tint);
+}
+
+// Stable LSD radix sort of the item order by texture, one 8 bit pass per byte that differs.
+static MARK_IGNORE_UNUSED_FUNC void SortSpriteBatchByTexture(SpriteBatch* batch) {
+  uint32_t count = batch->count;
+  uint32_t histograms[4][256];
+  memset(histograms, 0, sizeof(histograms));
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t key = (uint32_t)batch->items[i].texture;
+    batch->order[i] = i;
+    for (int pass = 0; pass < 4; pass++) histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+  }
+
+  uint32_t* src = batch->order;
+  uint32_t* dst = batch->orderScratch;
+  for (int pass = 0; pass < 4; pass++) {
+    uint32_t* histogram = histograms[pass];
+    uint32_t  firstKey = count ? ((uint32_t)batch->items[0].texture >> (pass * 8)) & 0xFF : 0;
+    if (histogram[firstKey] == count) continue; // Every key has the same byte, nothing to reorder.
+
+    uint32_t offset = 0;
+    for (int b = 0; b < 256; b++) {
+      uint32_t bucketSize = histogram[b];
+      histogram[b] = offset;
+      offset += bucketSize;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t key = ((uint32_t)batch->items[src[i]].texture >> (pass * 8)) & 0xFF;
+      dst[histogram[key]++] = src[i];
+    }
+    uint32_t* swap = src;
+    src = dst;
+    dst = swap;
+  }
+  if (src != batch->order) memcpy(batch->order, src, sizeof(uint32_t) * count);
+}
+
+// Writes the 4 corners of one item, matching what DrawTexturePro would send to rlgl.
+static MARK_IGNORE_UNUSED_FUNC void WriteSpriteQuad(SpriteVertex* out, const SpriteBatchItem* item, float textureWidth, float textureHeight) {
+  Rectangle source = item->source;
+  Rectangle dest = item->dest;
+  bool      flipX = false;
+  if (source.width < 0) {
+    flipX = true;
+    source.width *= -1;
+  }
+  if (source.height < 0) source.y -= source.height;
+  if (dest.width < 0) dest.width *= -1;
+  if (dest.height < 0) dest.height *= -1;
+
+  Vector2 topLeft, topRight, bottomLeft, bottomRight;
+  if (item->rotation == 0.0f) {
+    float x = dest.x - item->origin.x;
+    float y = dest.y - item->origin.y;
+    topLeft = (Vector2){x, y};
+    topRight = (Vector2){x + dest.width, y};
+    bottomLeft = (Vector2){x, y + dest.height};
+    bottomRight = (Vector2){x + dest.width, y + dest.height};
+  } else {
+    float sinRotation = sinf(item->rotation * DEG2RAD);
+    float cosRotation = cosf(item->rotation * DEG2RAD);
+    float x = dest.x, y = dest.y;
+    float dx = -item->origin.x, dy = -item->origin.y;
+    topLeft = (Vector2){x + dx * cosRotation - dy * sinRotation, y + dx * sinRotation + dy * cosRotation};
+    topRight = (Vector2){x + (dx + dest.width) * cosRotation - dy * sinRotation, y + (dx + dest.width) * sinRotation + dy * cosRotation};
+    bottomLeft = (Vector2){x + dx * cosRotation - (dy + dest.height) * sinRotation, y + dx * sinRotation + (dy + dest.height) * cosRotation};
+    bottomRight = (Vector2){x + (dx + dest.width) * cosRotation - (dy + dest.height) * sinRotation, y + (dx + dest.width) * sinRotation + (dy + dest.height) * cosRotation};
+  }
+
+  // Textures that failed to load have no size, their quads get zero UVs instead of NaNs.
+  float invWidth = textureWidth > 0 ? 1.0f / textureWidth : 0;
+  float invHeight = textureHeight > 0 ? 1.0f / textureHeight : 0;
+  float left = source.x * invWidth, right = (source.x + source.width) * invWidth;
+  float top = source.y * invHeight, bottom = (source.y + source.height) * invHeight;
+  if (flipX) {
+    float swap = left;
+    left = right;
+    right = swap;
+  }
+
+  out[0] = (SpriteVertex){topLeft.x, topLeft.y, left, top, item->tint};
+  out[1] = (SpriteVertex){bottomLeft.x, bottomLeft.y, left, bottom, item->tint};
+  out[2] = (SpriteVertex){bottomRight.x, bottomRight.y, right, bottom, item->tint};
+  out[3] = (SpriteVertex){topRight.x, topRight.y, right, top, item->tint};
+}
+
+// Expands the items in batch->order into quads, starting a new run on every texture change.
+// UVs come from the sizes in textureTable, textures[] outside of SpriteBatchSelfCheck.
+static MARK_IGNORE_UNUSED_FUNC void ExpandSpriteBatch(SpriteBatch* batch, const Texture2D* textureTable) {
+  batch->runCount = 0;
+  for (uint32_t q = 0; q < batch->count; q++) {
+    const SpriteBatchItem* item = &batch->items[batch->order[q]];
+    if (batch->runCount == 0 || batch->runs[batch->runCount - 1].texture != item->texture) {
+      batch->runs[batch->runCount++] = (SpriteBatchRun){item->texture, q, 0};
+    }
+    batch->runs[batch->runCount - 1].quadCount++;
+    Texture2D texture = textureTable[item->texture];
+    WriteSpriteQuad(&batch->vertices[q * 4], item, (float)texture.width, (float)texture.height);
+  }
+}
+
+// Sorts and expands everything pushed since BeginSpriteBatch. No raylib calls, safe off the main thread.
+static MARK_IGNORE_UNUSED_FUNC void BuildSpriteBatch(SpriteBatch* batch) {
+  SortSpriteBatchByTexture(batch);
+  ExpandSpriteBatch(batch, textures);
+}
+
+// Keeps push order, for callers that already sorted (see render_commands.h).
+static MARK_IGNORE_UNUSED_FUNC void BuildSpriteBatchInOrder(SpriteBatch* batch) {
+  for (uint32_t i = 0; i < batch->count; i++) batch->order[i] = i;
+  ExpandSpriteBatch(batch, textures);
+}
+
+// NOTE: Must be called inside BeginMode2D (or any mode DrawTexturePro would be), on the main thread.
+// Runs of evicted textures draw the placeholder and bring their texture back (texture_cache.h).
+static MARK_IGNORE_UNUSED_FUNC void SubmitSpriteBatch(const SpriteBatch* batch) {
+  for (uint32_t r = 0; r < batch->runCount; r++) {
+    const SpriteBatchRun* run = &batch->runs[r];
+    Texture2D             texture = GetDrawTexture(run->texture);
+    rlSetTexture(texture.id);
+    RecordRenderTexture(texture.id);
+    rlBegin(RL_QUADS);
+    rlNormal3f(0.0f, 0.0f, 1.0f); // Normal vector pointing towards viewer
+
+    Color color = batch->vertices[run->firstQuad * 4].color;
+    rlColor4ub(color.r, color.g, color.b, color.a);
+    for (uint32_t chunkStart = 0; chunkStart < run->quadCount; chunkStart += SPRITE_BATCH_SUBMIT_CHUNK) {
+      uint32_t chunkQuads = run->quadCount - chunkStart;
+      if (chunkQuads > SPRITE_BATCH_SUBMIT_CHUNK) chunkQuads = SPRITE_BATCH_SUBMIT_CHUNK;
+      rlCheckRenderBatchLimit((int)chunkQuads * 4); // Flush up front instead of mid chunk.
+      RecordRenderVertices(chunkQuads * 4);
+
+      const SpriteVertex* vertex = &batch->vertices[(run->firstQuad + chunkStart) * 4];
+      const SpriteVertex* end = vertex + chunkQuads * 4;
+      for (; vertex < end; vertex++) {
+        if (memcmp(&vertex->color, &color, sizeof(Color)) != 0) {
+          color = vertex->color;
+          rlColor4ub(color.r, color.g, color.b, color.a);
+        }
+        rlTexCoord2f(vertex->u, vertex->v);
+        rlVertex2f(vertex->x, vertex->y);
+      }
+    }
+    rlEnd();
+  }
+  rlSetTexture(0);
+  renderStats.spritesDrawn += batch->count;
+}
+
+// ::SPRITE BATCH SELF CHECK
+// Builds a small batch with interleaved textures and checks the runs, that quads keep push order
+// within a run, and their corners and UVs (one flipped). Headless, no raylib state is touched,
+// and UVs come from made up texture sizes, so it doesn't matter what has been uploaded yet.
+#define SPRITE_BATCH_CHECK_COUNT 5
+
+static MARK_IGNORE_UNUSED_FUNC bool SpriteBatchSelfCheck() {
+  static uint8_t   buffer[4096];
+  static Texture2D sizes[TEX_COUNT];
+  MemoryArena      arena;
+  sizes[TEX_NIL] = (Texture2D){.width = 64, .height = 32};
+  sizes[TEX_RAYLIB_LOGO] = (Texture2D){.width = 256, .height = 128};
+  assert(SpriteBatchArenaSize(SPRITE_BATCH_CHECK_COUNT) <= sizeof(buffer));
+  InitArena(&arena, sizeof(buffer), buffer);
+  SpriteBatch* batch = CreateSpriteBatch(&arena, SPRITE_BATCH_CHECK_COUNT);
+
+  // Logo, nil, logo, nil, logo: sorted into a nil run (items 1, 3) then a logo run (0, 2, 4).
+  BeginSpriteBatch(batch);
+  for (int i = 0; i < SPRITE_BATCH_CHECK_COUNT; i++) {
+    TextureID texture = (i & 1) ? TEX_NIL : TEX_RAYLIB_LOGO;
+    float     sourceWidth = i == 2 ? -8.0f : 8.0f; // Flipped.
+    Color     tint = (Color){(unsigned char)i, 0, 0, 255};
+    PushSpriteBatchItem(batch, texture, (Rectangle){4.0f * i, 2, sourceWidth, 6}, (Rectangle){100.0f * i, 50, 16, 12}, (Vector2){0, 0}, 0, tint);
+  }
+  SortSpriteBatchByTexture(batch);
+  ExpandSpriteBatch(batch, sizes);
+
+  const int EXPECTED_ORDER[SPRITE_BATCH_CHECK_COUNT] = {1, 3, 0, 2, 4};
+  const char* failed = 0;
+  if (batch->runCount != 2 || batch->runs[0].texture != TEX_NIL || batch->runs[0].quadCount != 2 ||
+      batch->runs[1].texture != TEX_RAYLIB_LOGO || batch->runs[1].firstQuad != 2 || batch->runs[1].quadCount != 3) failed = "runs";
+  for (int q = 0; q < SPRITE_BATCH_CHECK_COUNT && !failed; q++) {
+    int                 i = EXPECTED_ORDER[q];
+    const SpriteVertex* quad = &batch->vertices[q * 4];
+    Texture2D           texture = sizes[(i & 1) ? TEX_NIL : TEX_RAYLIB_LOGO];
+    float               invWidth = 1.0f / (float)texture.width;
+    float               invHeight = 1.0f / (float)texture.height;
+    float               left = (4.0f * i) * invWidth, right = (4.0f * i + 8) * invWidth;
+    float               top = 2 * invHeight, bottom = (2 + 6) * invHeight;
+    if (i == 2) {
+      float swap = left;
+      left = right;
+      right = swap;
+    }
+    if (quad[0].color.r != i) failed = "quad order";
+    else if (quad[0].x != 100.0f * i || quad[0].y != 50 || quad[2].x != 100.0f * i + 16 || quad[2].y != 62) failed = "corners";
+    else if (quad[0].u != left || quad[0].v != top || quad[1].u != left || quad[1].v != bottom ||
+             quad[2].u != right || quad[2].v != bottom || quad[3].u != right || quad[3].v != top) failed = "UVs";
+  }
+  if (failed) TraceLog(LOG_ERROR, "SPRITE BATCH: Self check failed, wrong %s", failed);
+  return !failed;
+}
+
+#endif // !SPRITE_BATCH_H
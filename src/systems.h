@@ -0,0 +1,159 @@
+#ifndef SYSTEMS_H
+#define SYSTEMS_H
+
+#include "include/raylib.h"
+#include "game_defines.h"
+#include "ecs.h"
+#include "spatial_grid.h"
+#include "simd_kernels.h"
+#include "culling.h"
+#include "render_commands.h"
+#include "y_sort.h"
+
+// ::SYSTEMS
+// Gameplay systems over the archetype ECS in ecs.h. Each system queries the components it
+// needs and walks the matching chunks, so anything with the right components takes part.
+#define MAX_PLAYERS 2
+
+static MARK_IGNORE_UNUSED_FUNC EcsEntity SpawnPlayer(EcsWorld* ecs, int playerIndex, Vector2 pos, SpriteID spriteID) {
+  ComponentMask mask = COMPONENT_BIT(COMP_POSITION) | COMPONENT_BIT(COMP_VELOCITY) |
+                       COMPONENT_BIT(COMP_SPRITE) | COMPONENT_BIT(COMP_PLAYER_CONTROL) |
+                       COMPONENT_BIT(COMP_COLLIDER);
+  EcsEntity         player = EcsCreateEntity(ecs, mask);
+  CompPlayerControl control = {playerIndex, 50.0f};
+  CompCollider      collider = {sprites[spriteID].size.x / 2};
+  EcsSetComponent(ecs, player, COMP_POSITION, &pos);
+  EcsSetComponent(ecs, player, COMP_SPRITE, &spriteID);
+  EcsSetComponent(ecs, player, COMP_PLAYER_CONTROL, &control);
+  EcsSetComponent(ecs, player, COMP_COLLIDER, &collider);
+  return player;
+}
+
+// moveDirs is indexed by CompPlayerControl.playerIndex.
+static MARK_IGNORE_UNUSED_FUNC void PlayerControlSystem(EcsWorld* ecs, const Vector2 moveDirs[MAX_PLAYERS]) {
+  EcsQuery query = EcsQueryBegin(ecs, COMPONENT_BIT(COMP_VELOCITY) | COMPONENT_BIT(COMP_PLAYER_CONTROL), 0);
+  while (EcsQueryNext(&query)) {
+    CompVelocity*      vel = EcsChunkComponents(query.chunk, COMP_VELOCITY, CompVelocity);
+    CompPlayerControl* control = EcsChunkComponents(query.chunk, COMP_PLAYER_CONTROL, CompPlayerControl);
+    for (uint32_t i = 0; i < query.chunk->count; i++) {
+      Vector2 dir = moveDirs[control[i].playerIndex];
+      vel[i] = (Vector2){dir.x * control[i].moveSpeed, dir.y * control[i].moveSpeed};
+    }
+  }
+}
+
+static MARK_IGNORE_UNUSED_FUNC void MovementSystem(EcsWorld* ecs, float deltaTime) {
+  EcsQuery query = EcsQueryBegin(ecs, COMPONENT_BIT(COMP_POSITION) | COMPONENT_BIT(COMP_VELOCITY), 0);
+  while (EcsQueryNext(&query)) {
+    CompPosition*       pos = EcsChunkComponents(query.chunk, COMP_POSITION, CompPosition);
+    const CompVelocity* vel = EcsChunkComponents(query.chunk, COMP_VELOCITY, CompVelocity);
+    SimdIntegrate((float*)pos, (const float*)vel, query.chunk->count * 2, deltaTime); // x and y interleaved, same math.
+  }
+}
+
+// Overlapping collider pairs for this tick. pairs index into entities, everything lives in the frame arena.
+typedef struct CollisionContacts {
+  EcsEntity*   entities;
+  SpatialPair* pairs;
+  uint32_t     pairCount;
+} CollisionContacts;
+
+#define COLLISION_CELL_SIZE 128.0f
+
+// Gathers every collider into the frame arena, rebuilds the broadphase grid and reports overlapping pairs.
+static MARK_IGNORE_UNUSED_FUNC CollisionContacts CollisionSystem(EcsWorld* ecs, MemoryArena* frameArena) {
+  ComponentMask required = COMPONENT_BIT(COMP_POSITION) | COMPONENT_BIT(COMP_COLLIDER);
+  uint32_t      count = 0;
+  EcsQuery      query = EcsQueryBegin(ecs, required, 0);
+  while (EcsQueryNext(&query)) count += query.chunk->count;
+
+  CollisionContacts contacts = {0};
+  contacts.entities = PushArray(frameArena, count, EcsEntity);
+  float* posX = PushArray(frameArena, count, float);
+  float* posY = PushArray(frameArena, count, float);
+  float* radius = PushArray(frameArena, count, float);
+
+  uint32_t item = 0;
+  query = EcsQueryBegin(ecs, required, 0);
+  while (EcsQueryNext(&query)) {
+    EcsEntity*    entities = EcsChunkEntities(query.chunk);
+    CompPosition* pos = EcsChunkComponents(query.chunk, COMP_POSITION, CompPosition);
+    CompCollider* collider = EcsChunkComponents(query.chunk, COMP_COLLIDER, CompCollider);
+    for (uint32_t i = 0; i < query.chunk->count; i++, item++) {
+      contacts.entities[item] = entities[i];
+      posX[item] = pos[i].x;
+      posY[item] = pos[i].y;
+      radius[item] = collider[i].radius;
+    }
+  }
+
+  SpatialGrid* grid = BuildSpatialGrid(frameArena, posX, posY, radius, 0, count, COLLISION_CELL_SIZE);
+  SpatialPairs pairs = FindOverlappingPairs(grid, frameArena);
+  contacts.pairs = pairs.pairs;
+  contacts.pairCount = pairs.count;
+  return contacts;
+}
+
+// Everything the render task needs to draw the world, built off the main thread.
+typedef struct RenderPacket {
+  RenderCommandBuffer* commands; // World sprites inside the view, plus whatever the render task adds.
+  CullStats            cull;
+} RenderPacket;
+
+// World sprites are culled with the SIMD rect test, not a grid: every one of them is gathered and
+// Y sorted each frame anyway (so the order carries over), which is O(n) already. The collision
+// grid only holds colliders and is built by a task that runs alongside this one.
+static MARK_IGNORE_UNUSED_FUNC RenderPacket BuildRenderPacket(EcsWorld* ecs, Camera2D camera, Rectangle view, YSortIndex* ysort, RenderCommandBuffer* commands, MemoryArena* frameArena) {
+  ComponentMask required = COMPONENT_BIT(COMP_POSITION) | COMPONENT_BIT(COMP_SPRITE);
+  uint32_t      count = 0;
+  EcsQuery      query = EcsQueryBegin(ecs, required, 0);
+  while (EcsQueryNext(&query)) count += query.chunk->count;
+
+  SpriteID* spriteIDs = PushArray(frameArena, count, SpriteID);
+  float*    destX = PushArray(frameArena, count, float);
+  float*    destY = PushArray(frameArena, count, float);
+  float*    destW = PushArray(frameArena, count, float);
+  float*    destH = PushArray(frameArena, count, float);
+  float*    sortY = PushArray(frameArena, count, float);
+
+  uint32_t item = 0;
+  query = EcsQueryBegin(ecs, required, 0);
+  while (EcsQueryNext(&query)) {
+    CompPosition* pos = EcsChunkComponents(query.chunk, COMP_POSITION, CompPosition);
+    CompSprite*   sprite = EcsChunkComponents(query.chunk, COMP_SPRITE, CompSprite);
+    for (uint32_t i = 0; i < query.chunk->count; i++, item++) {
+      Vector2 size = sprites[sprite[i]].size;
+      spriteIDs[item] = sprite[i];
+      destX[item] = pos[i].x - (size.x / 2);
+      destY[item] = pos[i].y - (size.y / 2);
+      destW[item] = size.x;
+      destH[item] = size.y;
+      sortY[item] = pos[i].y + (size.y / 2); // Feet, so whoever stands lower is drawn on top.
+    }
+  }
+
+  // Sorted before culling so the order carries over between frames, see y_sort.h.
+  const uint32_t* order = UpdateYSortIndex(ysort, sortY, count);
+  count = ysort->count; // Clamped to the index's capacity, items past it aren't drawn.
+  uint8_t*        hits = PushArray(frameArena, count, uint8_t);
+  uint32_t        visibleCount = BatchCheckCollisionRecs(destX, destY, destW, destH, count, view, hits);
+
+  PushRenderCamera(commands, RENDER_LAYER_WORLD, camera);
+  uint32_t slot = ReserveRenderCommands(commands, visibleCount);
+  uint64_t key = MakeOrderedRenderKey(RENDER_LAYER_WORLD);
+  for (uint32_t k = 0; slot != UINT32_MAX && k < count; k++) {
+    uint32_t i = order[k];
+    if (!hits[i]) continue;
+    SpriteData    spriteData = sprites[spriteIDs[i]];
+    RenderCommand command = {.type = RENDER_CMD_SPRITE};
+    command.sprite = (SpriteBatchItem){spriteData.sourceTexture, spriteData.sourceRect, {destX[i], destY[i], destW[i], destH[i]}, {0, 0}, 0, WHITE};
+    WriteRenderCommand(commands, slot++, key, command);
+  }
+
+  RenderPacket packet = {0};
+  packet.commands = commands;
+  packet.cull = (CullStats){visibleCount, count - visibleCount};
+  return packet;
+}
+
+#endif // !SYSTEMS_H
@@ -0,0 +1,215 @@
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include "include/raylib.h"
+#include "job_system.h"
+#include "mem_arena.h"
+#include "utils.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+// ::TASK GRAPH
+// Frame work declared as tasks with read/write sets over world resources. Dependencies are
+// derived in declaration order: a task waits on every earlier task it conflicts with
+// (write/write, read/write or write/read). Tasks that don't conflict run concurrently on the
+// job system, picking the ready task with the longest remaining path first, using last frame's
+// measured durations as estimates. TASK_MAIN_THREAD tasks (raylib input, drawing) only ever
+// run on the main thread.
+#define TASK_GRAPH_MAX_TASKS 32
+#define TASK_NAME_LENGTH 32
+
+typedef void (*FrameTaskFunc)(void* data);
+
+typedef enum FrameTaskFlags {
+  TASK_NONE = 0,
+  TASK_MAIN_THREAD = 1 << 0,
+} FrameTaskFlags;
+
+typedef struct FrameTask {
+  char          name[TASK_NAME_LENGTH];
+  FrameTaskFunc func;
+  void*         data;
+  uint32_t      reads;
+  uint32_t      writes;
+  uint32_t      flags;
+
+  uint64_t   successors; // Bitmask of task indices that wait on this task.
+  int        dependencyCount;
+  atomic_int remainingDependencies;
+
+  double priorityMs; // Estimated longest path from the start of this task to the end of the frame.
+  double startMs;
+  double durationMs;
+} FrameTask;
+
+typedef struct TaskGraph {
+  FrameTask tasks[TASK_GRAPH_MAX_TASKS];
+  int       taskCount;
+
+  // Ready tasks, guarded by readyMutex.
+  pthread_mutex_t readyMutex;
+  uint64_t        readyWorker;
+  uint64_t        readyMain;
+  atomic_int      remainingTasks;
+  JobSystem*      jobs;
+  double          frameStartTime;
+
+  // Stats from the last RunTaskGraph.
+  double   frameMs;
+  double   criticalPathMs; // Longest chain of measured task durations through the dependencies.
+  uint64_t criticalPath;   // Bitmask of the tasks on that chain.
+} TaskGraph;
+
+static MARK_IGNORE_UNUSED_FUNC TaskGraph* CreateTaskGraph(MemoryArena* arena) {
+  TaskGraph* graph = PushType(arena, TaskGraph);
+  memset(graph, 0, sizeof(TaskGraph));
+  pthread_mutex_init(&graph->readyMutex, 0);
+  return graph;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void DestroyTaskGraph(TaskGraph* graph) {
+  pthread_mutex_destroy(&graph->readyMutex);
+}
+
+// Declaration order matters: it is the order conflicting tasks run in.
+static MARK_IGNORE_UNUSED_FUNC int AddFrameTask(TaskGraph* graph, const char* name, FrameTaskFunc func, void* data, uint32_t reads, uint32_t writes, uint32_t flags) {
+  assert(graph->taskCount < TASK_GRAPH_MAX_TASKS && "Too many frame tasks, bump TASK_GRAPH_MAX_TASKS");
+  int        index = graph->taskCount++;
+  FrameTask* task = &graph->tasks[index];
+  memset(task, 0, sizeof(FrameTask));
+  strncpy(task->name, name, TASK_NAME_LENGTH - 1);
+  task->func = func;
+  task->data = data;
+  task->reads = reads;
+  task->writes = writes;
+  task->flags = flags;
+
+  for (int i = 0; i < index; i++) {
+    FrameTask* earlier = &graph->tasks[i];
+    bool       conflicts = (earlier->writes & (reads | writes)) || (earlier->reads & writes);
+    if (!conflicts) continue;
+    earlier->successors |= 1ull << index;
+    task->dependencyCount++;
+  }
+  return index;
+}
+
+// Bottom level of every task: its duration plus the longest path through its successors.
+static MARK_IGNORE_UNUSED_FUNC void ComputeTaskPriorities(TaskGraph* graph) {
+  for (int i = graph->taskCount - 1; i >= 0; i--) { // Successors always have higher indices.
+    FrameTask* task = &graph->tasks[i];
+    double     longestTail = 0;
+    for (int s = i + 1; s < graph->taskCount; s++) {
+      if ((task->successors & (1ull << s)) && graph->tasks[s].priorityMs > longestTail) longestTail = graph->tasks[s].priorityMs;
+    }
+    // Tasks never measured yet get a tiny cost so path length still breaks ties.
+    task->priorityMs = (task->durationMs > 0 ? task->durationMs : 0.001) + longestTail;
+  }
+}
+
+static MARK_IGNORE_UNUSED_FUNC int PopHighestPriorityTask(TaskGraph* graph, uint64_t* readySet) {
+  int    best = -1;
+  double bestPriority = -1;
+  for (int i = 0; i < graph->taskCount; i++) {
+    if (!(*readySet & (1ull << i))) continue;
+    if (graph->tasks[i].priorityMs > bestPriority) {
+      best = i;
+      bestPriority = graph->tasks[i].priorityMs;
+    }
+  }
+  if (best >= 0) *readySet &= ~(1ull << best);
+  return best;
+}
+
+static void RunReadyWorkerTask(void* data, MemoryArena* scratch);
+static MARK_IGNORE_UNUSED_FUNC void MarkTaskReady(TaskGraph* graph, int index) {
+  bool mainThread = graph->tasks[index].flags & TASK_MAIN_THREAD;
+  pthread_mutex_lock(&graph->readyMutex);
+  if (mainThread) graph->readyMain |= 1ull << index;
+  else graph->readyWorker |= 1ull << index;
+  pthread_mutex_unlock(&graph->readyMutex);
+
+  // One job per ready task, but each job picks whatever ready task is most critical at that moment.
+  if (!mainThread) SubmitJob(graph->jobs, RunReadyWorkerTask, graph, 0);
+}
+
+static MARK_IGNORE_UNUSED_FUNC void ExecuteFrameTask(TaskGraph* graph, int index) {
+  FrameTask* task = &graph->tasks[index];
+  double     startTime = GetTime();
+  task->func(task->data);
+  double endTime = GetTime();
+  task->startMs = (startTime - graph->frameStartTime) * 1000.0;
+  task->durationMs = (endTime - startTime) * 1000.0;
+
+  for (int s = index + 1; s < graph->taskCount; s++) {
+    if (!(task->successors & (1ull << s))) continue;
+    if (atomic_fetch_sub(&graph->tasks[s].remainingDependencies, 1) == 1) MarkTaskReady(graph, s);
+  }
+  atomic_fetch_sub(&graph->remainingTasks, 1);
+}
+
+static void RunReadyWorkerTask(void* data, MemoryArena* scratch) {
+  (void)scratch;
+  TaskGraph* graph = (TaskGraph*)data;
+  pthread_mutex_lock(&graph->readyMutex);
+  int index = PopHighestPriorityTask(graph, &graph->readyWorker);
+  pthread_mutex_unlock(&graph->readyMutex);
+  if (index >= 0) ExecuteFrameTask(graph, index);
+}
+
+// Longest chain of this frame's measured durations, walked back to front.
+static MARK_IGNORE_UNUSED_FUNC void ComputeCriticalPath(TaskGraph* graph) {
+  double pathMs[TASK_GRAPH_MAX_TASKS];
+  int    next[TASK_GRAPH_MAX_TASKS];
+  int    head = -1;
+  graph->criticalPathMs = 0;
+  for (int i = graph->taskCount - 1; i >= 0; i--) {
+    FrameTask* task = &graph->tasks[i];
+    pathMs[i] = task->durationMs;
+    next[i] = -1;
+    for (int s = i + 1; s < graph->taskCount; s++) {
+      if ((task->successors & (1ull << s)) && task->durationMs + pathMs[s] > pathMs[i]) {
+        pathMs[i] = task->durationMs + pathMs[s];
+        next[i] = s;
+      }
+    }
+    if (task->dependencyCount == 0 && pathMs[i] > graph->criticalPathMs) {
+      graph->criticalPathMs = pathMs[i];
+      head = i;
+    }
+  }
+
+  graph->criticalPath = 0;
+  for (int i = head; i >= 0; i = next[i]) graph->criticalPath |= 1ull << i;
+}
+
+// Runs every task once. The calling (main) thread runs main thread tasks and helps with the rest.
+static MARK_IGNORE_UNUSED_FUNC void RunTaskGraph(TaskGraph* graph, JobSystem* jobs) {
+  graph->jobs = jobs;
+  graph->frameStartTime = GetTime();
+  graph->readyWorker = 0;
+  graph->readyMain = 0;
+  ComputeTaskPriorities(graph);
+
+  atomic_store(&graph->remainingTasks, graph->taskCount);
+  for (int i = 0; i < graph->taskCount; i++) atomic_store(&graph->tasks[i].remainingDependencies, graph->tasks[i].dependencyCount);
+  for (int i = 0; i < graph->taskCount; i++) {
+    if (graph->tasks[i].dependencyCount == 0) MarkTaskReady(graph, i);
+  }
+
+  while (atomic_load(&graph->remainingTasks) > 0) {
+    pthread_mutex_lock(&graph->readyMutex);
+    int mainTask = PopHighestPriorityTask(graph, &graph->readyMain);
+    pthread_mutex_unlock(&graph->readyMutex);
+
+    if (mainTask >= 0) ExecuteFrameTask(graph, mainTask);
+    else if (!TryRunOneJob(jobs)) sched_yield();
+  }
+
+  graph->frameMs = (GetTime() - graph->frameStartTime) * 1000.0;
+  ComputeCriticalPath(graph);
+}
+
+#endif // !TASK_GRAPH_H
@@ -0,0 +1,288 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include "include/raylib.h"
+#include "game_defines.h"
+#include "mem_arena.h"
+#include "render_commands.h"
+#include "sprite_batch.h"
+#include "utils.h"
+#include <stdint.h>
+#include <string.h>
+
+// ::TEXT CACHE
+// Laid out text, keyed by (string hash, font texture, size, spacing). The first draw of a
+// string walks its codepoints once like DrawTextEx does and stores one quad per glyph;
+// after that drawing it is a hash lookup plus pushing the quads into the sprite batch, so
+// labels that don't change cost next to nothing and all share the font's texture run.
+// Glyphs live in fixed size chunks from the arena. When entries or chunks run out, the
+// least recently used texts are evicted. Main thread only.
+// NOTE: Strings are identified by a 64 bit hash plus length, collisions aren't checked.
+// NOTE: Newlines use raylib's default line spacing (2), there is no getter for the current one.
+#define TEXT_CACHE_CHUNK_GLYPHS 16
+#define TEXT_CACHE_LINE_SPACING 2
+#define TEXT_CACHE_NONE UINT32_MAX
+
+typedef struct CachedGlyph {
+  Rectangle source;
+  Rectangle dest; // Relative to the text's position.
+} CachedGlyph;
+
+typedef struct TextGlyphChunk {
+  CachedGlyph glyphs[TEXT_CACHE_CHUNK_GLYPHS];
+  uint32_t    next;
+} TextGlyphChunk;
+
+typedef struct CachedText {
+  uint64_t  hash;
+  uint32_t  length;
+  TextureID fontTexture;
+  float     fontSize;
+  float     spacing;
+  uint32_t  glyphCount;
+  uint32_t  firstChunk;
+  uint32_t  hashNext;
+  uint32_t  lruPrev, lruNext; // Most recent first.
+} CachedText;
+
+typedef struct TextCache {
+  uint32_t        entryCapacity;
+  CachedText*     entries;
+  uint32_t        freeEntry; // Linked through hashNext.
+  uint32_t        bucketMask;
+  uint32_t*       buckets;
+  uint32_t        chunkCapacity;
+  TextGlyphChunk* chunks;
+  uint32_t        freeChunk;
+  uint32_t        freeChunkCount;
+  uint32_t        lruHead, lruTail;
+
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t evictions;
+} TextCache;
+
+static MARK_IGNORE_UNUSED_FUNC size_t TextCacheArenaSize(uint32_t entryCapacity, uint32_t glyphCapacity) {
+  uint32_t chunkCount = (glyphCapacity + TEXT_CACHE_CHUNK_GLYPHS - 1) / TEXT_CACHE_CHUNK_GLYPHS;
+  return AlignUpMaxAlignment(sizeof(TextCache)) +
+         AlignUpMaxAlignment(sizeof(CachedText) * entryCapacity) +
+         AlignUpMaxAlignment(sizeof(uint32_t) * entryCapacity * 2) + // Buckets, rounded up to a power of two.
+         AlignUpMaxAlignment(sizeof(TextGlyphChunk) * chunkCount);
+}
+
+static MARK_IGNORE_UNUSED_FUNC TextCache* CreateTextCache(MemoryArena* arena, uint32_t entryCapacity, uint32_t glyphCapacity) {
+  TextCache* cache = PushType(arena, TextCache);
+  memset(cache, 0, sizeof(TextCache));
+  cache->entryCapacity = entryCapacity;
+  cache->entries = PushArray(arena, entryCapacity, CachedText);
+  for (uint32_t i = 0; i < entryCapacity; i++) cache->entries[i].hashNext = i + 1 < entryCapacity ? i + 1 : TEXT_CACHE_NONE;
+  cache->freeEntry = entryCapacity ? 0 : TEXT_CACHE_NONE;
+
+  uint32_t bucketCount = 1;
+  while (bucketCount < entryCapacity) bucketCount <<= 1;
+  cache->bucketMask = bucketCount - 1;
+  cache->buckets = PushArray(arena, bucketCount, uint32_t);
+  for (uint32_t i = 0; i < bucketCount; i++) cache->buckets[i] = TEXT_CACHE_NONE;
+
+  cache->chunkCapacity = (glyphCapacity + TEXT_CACHE_CHUNK_GLYPHS - 1) / TEXT_CACHE_CHUNK_GLYPHS;
+  cache->chunks = PushArray(arena, cache->chunkCapacity, TextGlyphChunk);
+  for (uint32_t i = 0; i < cache->chunkCapacity; i++) cache->chunks[i].next = i + 1 < cache->chunkCapacity ? i + 1 : TEXT_CACHE_NONE;
+  cache->freeChunk = cache->chunkCapacity ? 0 : TEXT_CACHE_NONE;
+  cache->freeChunkCount = cache->chunkCapacity;
+  cache->lruHead = cache->lruTail = TEXT_CACHE_NONE;
+  return cache;
+}
+
+// FNV-1a
+static MARK_IGNORE_UNUSED_FUNC uint64_t HashTextBytes(const char* text, uint32_t length) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (uint32_t i = 0; i < length; i++) {
+    hash ^= (uint8_t)text[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+static MARK_IGNORE_UNUSED_FUNC uint32_t TextCacheBucket(const TextCache* cache, uint64_t hash, TextureID fontTexture, float fontSize, float spacing) {
+  uint32_t sizeBits, spacingBits;
+  memcpy(&sizeBits, &fontSize, sizeof(sizeBits));
+  memcpy(&spacingBits, &spacing, sizeof(spacingBits));
+  uint64_t mixed = hash ^ ((uint64_t)fontTexture << 48) ^ ((uint64_t)sizeBits * 0x9E3779B97F4A7C15ull) ^ spacingBits;
+  return (uint32_t)(mixed ^ (mixed >> 32)) & cache->bucketMask;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void UnlinkTextLRU(TextCache* cache, uint32_t id) {
+  CachedText* entry = &cache->entries[id];
+  if (entry->lruPrev != TEXT_CACHE_NONE) cache->entries[entry->lruPrev].lruNext = entry->lruNext;
+  else cache->lruHead = entry->lruNext;
+  if (entry->lruNext != TEXT_CACHE_NONE) cache->entries[entry->lruNext].lruPrev = entry->lruPrev;
+  else cache->lruTail = entry->lruPrev;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void PushTextLRUFront(TextCache* cache, uint32_t id) {
+  CachedText* entry = &cache->entries[id];
+  entry->lruPrev = TEXT_CACHE_NONE;
+  entry->lruNext = cache->lruHead;
+  if (cache->lruHead != TEXT_CACHE_NONE) cache->entries[cache->lruHead].lruPrev = id;
+  cache->lruHead = id;
+  if (cache->lruTail == TEXT_CACHE_NONE) cache->lruTail = id;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void EvictLeastRecentText(TextCache* cache) {
+  uint32_t    id = cache->lruTail;
+  CachedText* entry = &cache->entries[id];
+  UnlinkTextLRU(cache, id);
+
+  uint32_t* link = &cache->buckets[TextCacheBucket(cache, entry->hash, entry->fontTexture, entry->fontSize, entry->spacing)];
+  while (*link != id) link = &cache->entries[*link].hashNext;
+  *link = entry->hashNext;
+
+  uint32_t chunk = entry->firstChunk;
+  while (chunk != TEXT_CACHE_NONE) {
+    uint32_t next = cache->chunks[chunk].next;
+    cache->chunks[chunk].next = cache->freeChunk;
+    cache->freeChunk = chunk;
+    cache->freeChunkCount++;
+    chunk = next;
+  }
+  entry->hashNext = cache->freeEntry;
+  cache->freeEntry = id;
+  cache->evictions++;
+}
+
+// Counts the glyphs DrawTextEx would draw, spaces, tabs and newlines take no quad.
+static MARK_IGNORE_UNUSED_FUNC uint32_t CountVisibleGlyphs(const char* text, uint32_t length) {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < length;) {
+    int codepointSize = 0;
+    int codepoint = GetCodepointNext(&text[i], &codepointSize);
+    if (codepoint != ' ' && codepoint != '\t' && codepoint != '\n') count++;
+    i += codepointSize;
+  }
+  return count;
+}
+
+// Same layout as DrawTextEx + DrawTextCodepoint, into the entry's chunks.
+static MARK_IGNORE_UNUSED_FUNC void LayoutCachedText(TextCache* cache, CachedText* entry, Font font, const char* text) {
+  float        scale = entry->fontSize / (float)font.baseSize;
+  float        padding = (float)font.glyphPadding;
+  float        offsetX = 0, offsetY = 0;
+  uint32_t     glyph = 0;
+  CachedGlyph* out = 0;
+  uint32_t     chunk = TEXT_CACHE_NONE;
+  for (uint32_t i = 0; i < entry->length;) {
+    int codepointSize = 0;
+    int codepoint = GetCodepointNext(&text[i], &codepointSize);
+    int index = GetGlyphIndex(font, codepoint);
+    i += codepointSize;
+    if (codepoint == '\n') {
+      offsetY += entry->fontSize + TEXT_CACHE_LINE_SPACING;
+      offsetX = 0;
+      continue;
+    }
+
+    Rectangle rec = font.recs[index];
+    if (codepoint != ' ' && codepoint != '\t') {
+      if (glyph % TEXT_CACHE_CHUNK_GLYPHS == 0) {
+        chunk = chunk == TEXT_CACHE_NONE ? entry->firstChunk : cache->chunks[chunk].next;
+        out = cache->chunks[chunk].glyphs;
+      }
+      out[glyph % TEXT_CACHE_CHUNK_GLYPHS] = (CachedGlyph){
+          .source = {rec.x - padding, rec.y - padding, rec.width + 2.0f * padding, rec.height + 2.0f * padding},
+          .dest = {
+              offsetX + font.glyphs[index].offsetX * scale - padding * scale,
+              offsetY + font.glyphs[index].offsetY * scale - padding * scale,
+              (rec.width + 2.0f * padding) * scale,
+              (rec.height + 2.0f * padding) * scale},
+      };
+      glyph++;
+    }
+    if (font.glyphs[index].advanceX == 0) offsetX += rec.width * scale + entry->spacing;
+    else offsetX += (float)font.glyphs[index].advanceX * scale + entry->spacing;
+  }
+}
+
+// Returns the laid out text, laying it out on a miss. 0 if it has more glyphs than the whole cache.
+static MARK_IGNORE_UNUSED_FUNC const CachedText* GetCachedText(TextCache* cache, Font font, TextureID fontTexture, const char* text, float fontSize, float spacing) {
+  uint32_t length = (uint32_t)strlen(text);
+  uint64_t hash = HashTextBytes(text, length);
+  uint32_t bucket = TextCacheBucket(cache, hash, fontTexture, fontSize, spacing);
+  for (uint32_t id = cache->buckets[bucket]; id != TEXT_CACHE_NONE; id = cache->entries[id].hashNext) {
+    CachedText* entry = &cache->entries[id];
+    if (entry->hash != hash || entry->length != length || entry->fontTexture != fontTexture || entry->fontSize != fontSize || entry->spacing != spacing) continue;
+    UnlinkTextLRU(cache, id);
+    PushTextLRUFront(cache, id);
+    cache->hits++;
+    return entry;
+  }
+
+  cache->misses++;
+  uint32_t glyphCount = CountVisibleGlyphs(text, length);
+  uint32_t chunkCount = (glyphCount + TEXT_CACHE_CHUNK_GLYPHS - 1) / TEXT_CACHE_CHUNK_GLYPHS;
+  if (chunkCount > cache->chunkCapacity || cache->entryCapacity == 0) return 0;
+  while (cache->freeEntry == TEXT_CACHE_NONE || cache->freeChunkCount < chunkCount) EvictLeastRecentText(cache);
+
+  uint32_t    id = cache->freeEntry;
+  CachedText* entry = &cache->entries[id];
+  cache->freeEntry = entry->hashNext;
+  *entry = (CachedText){hash, length, fontTexture, fontSize, spacing, glyphCount, TEXT_CACHE_NONE, cache->buckets[bucket], TEXT_CACHE_NONE, TEXT_CACHE_NONE};
+  cache->buckets[bucket] = id;
+  PushTextLRUFront(cache, id);
+
+  // Chunks are linked in order, the layout walks them front to back.
+  uint32_t* link = &entry->firstChunk;
+  for (uint32_t c = 0; c < chunkCount; c++) {
+    uint32_t chunk = cache->freeChunk;
+    cache->freeChunk = cache->chunks[chunk].next;
+    cache->freeChunkCount--;
+    *link = chunk;
+    link = &cache->chunks[chunk].next;
+  }
+  *link = TEXT_CACHE_NONE;
+
+  LayoutCachedText(cache, entry, font, text);
+  return entry;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void PushCachedTextToBatch(TextCache* cache, const CachedText* text, SpriteBatch* batch, Vector2 position, Color tint) {
+  uint32_t remaining = text->glyphCount;
+  for (uint32_t chunk = text->firstChunk; chunk != TEXT_CACHE_NONE; chunk = cache->chunks[chunk].next) {
+    uint32_t count = remaining < TEXT_CACHE_CHUNK_GLYPHS ? remaining : TEXT_CACHE_CHUNK_GLYPHS;
+    for (uint32_t g = 0; g < count; g++) {
+      const CachedGlyph* glyph = &cache->chunks[chunk].glyphs[g];
+      Rectangle          dest = (Rectangle){position.x + glyph->dest.x, position.y + glyph->dest.y, glyph->dest.width, glyph->dest.height};
+      PushSpriteBatchItem(batch, text->fontTexture, glyph->source, dest, (Vector2){0, 0}, 0, tint);
+    }
+    remaining -= count;
+  }
+}
+
+// Glyphs become sprite commands in one block, so they batch with every other font glyph of the layer.
+static MARK_IGNORE_UNUSED_FUNC void PushCachedTextCommands(TextCache* cache, const CachedText* text, RenderCommandBuffer* buffer, RenderLayer layer, Vector2 position, Color tint) {
+  uint32_t slot = ReserveRenderCommands(buffer, text->glyphCount);
+  if (slot == UINT32_MAX) return;
+  uint64_t key = MakeRenderKey(layer, RENDER_PHASE_DRAW, 0, text->fontTexture, 0);
+  uint32_t remaining = text->glyphCount;
+  for (uint32_t chunk = text->firstChunk; chunk != TEXT_CACHE_NONE; chunk = cache->chunks[chunk].next) {
+    uint32_t count = remaining < TEXT_CACHE_CHUNK_GLYPHS ? remaining : TEXT_CACHE_CHUNK_GLYPHS;
+    for (uint32_t g = 0; g < count; g++) {
+      const CachedGlyph* glyph = &cache->chunks[chunk].glyphs[g];
+      RenderCommand      command = {.type = RENDER_CMD_SPRITE};
+      command.sprite = (SpriteBatchItem){text->fontTexture, glyph->source, {position.x + glyph->dest.x, position.y + glyph->dest.y, glyph->dest.width, glyph->dest.height}, {0, 0}, 0, tint};
+      WriteRenderCommand(buffer, slot++, key, command);
+    }
+    remaining -= count;
+  }
+}
+
+// Cached DrawText: the default font with DrawText's size and spacing rules.
+static MARK_IGNORE_UNUSED_FUNC void PushCachedRenderText(TextCache* cache, RenderCommandBuffer* buffer, RenderLayer layer, const char* text, int posX, int posY, int fontSize, Color color) {
+  const int DEFAULT_FONT_SIZE = 10;
+  if (fontSize < DEFAULT_FONT_SIZE) fontSize = DEFAULT_FONT_SIZE;
+  int spacing = fontSize / DEFAULT_FONT_SIZE;
+  const CachedText* cached = GetCachedText(cache, GetFontDefault(), TEX_FONT_DEFAULT, text, (float)fontSize, (float)spacing);
+  if (cached) PushCachedTextCommands(cache, cached, buffer, layer, (Vector2){(float)posX, (float)posY}, color);
+  else PushRenderText(buffer, layer, text, posX, posY, fontSize, color);
+}
+
+#endif // !TEXT_CACHE_H
@@ -0,0 +1,158 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include "include/raylib.h"
+#include "game_defines.h"
+#include "texture_packer_utils.h"
+#include "utils.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// ::TEXTURE CACHE
+// Residency for textures[]: a TextureID is the handle, the cache tracks who holds it and when it
+// was last drawn, and keeps resident textures within a GPU memory budget:
+// - AcquireTexture/ReleaseTexture count references (e.g. a level holding its atlases).
+// - Draws go through GetDrawTexture, which marks the texture used this frame.
+// - When a new texture doesn't fit, resident textures nobody references or that haven't been
+//   drawn for TEXTURE_IDLE_FRAMES are unloaded, least recently drawn first.
+// An evicted texture keeps its size in textures[], so sprite UVs stay right, and draws bind the
+// placeholder until it's back: using it again queues a reload from the same files
+// (UpdateTextureResidency in asset_loader.h). Textures without files (TEX_NIL, the font) stay.
+// NOTE: Main thread only.
+#ifndef TEXTURE_BUDGET_BYTES
+#define TEXTURE_BUDGET_BYTES (256u * 1024 * 1024) // Override per target, e.g. -DTEXTURE_BUDGET_BYTES=67108864.
+#endif
+#define TEXTURE_IDLE_FRAMES 300 // Referenced textures not drawn for this long can be evicted too.
+
+// Where a texture reloads from, see RequestTextureLoad.
+typedef struct TextureSource {
+  const char*        rawFileName; // Pre-decoded .rtex (texture_format.h), or NULL.
+  const char*        fileName;    // Image file, used when there's no .rtex or it doesn't check out.
+  const AtlasSprite* sprites;     // Set up on the texture once it's uploaded.
+  int                spriteCount;
+  SpriteID           wholeSprite; // Covers the whole texture once uploaded, or SPRITE_NIL.
+} TextureSource;
+
+typedef struct TextureResidency {
+  TextureSource source; // fileName is NULL for textures that can't be reloaded.
+  int32_t       refCount;
+  uint64_t      lastUsedFrame;
+  uint64_t      bytes; // While resident.
+  bool          resident;
+  bool          loading;
+  bool          wanted; // Used while evicted, reload it.
+  bool          failed; // Last load failed, don't retry on every use.
+} TextureResidency;
+
+typedef struct TextureCacheStats {
+  uint32_t residentCount;
+  uint64_t residentBytes;
+  uint64_t budgetBytes;
+  uint32_t evictions; // Since start.
+  uint32_t reloads;
+  bool     overBudget; // Everything resident is in use and still doesn't fit.
+} TextureCacheStats;
+
+typedef struct TextureCache {
+  TextureResidency  textures[TEX_COUNT];
+  uint64_t          frame;
+  TextureCacheStats stats;
+} TextureCache;
+
+TextureCache textureCache = {.stats.budgetBytes = TEXTURE_BUDGET_BYTES};
+
+static MARK_IGNORE_UNUSED_FUNC void SetTextureBudget(uint64_t bytes) { textureCache.stats.budgetBytes = bytes; }
+static MARK_IGNORE_UNUSED_FUNC TextureCacheStats GetTextureCacheStats(void) { return textureCache.stats; }
+
+static MARK_IGNORE_UNUSED_FUNC uint64_t GetTextureBytes(Texture2D texture) {
+  uint64_t bytes = (uint64_t)GetPixelDataSize(texture.width, texture.height, texture.format);
+  return texture.mipmaps > 1 ? bytes * 4 / 3 : bytes; // Full mip chain.
+}
+
+// Texture handed over by the loader (or loaded by hand, e.g. the placeholder). source can be
+// NULL for textures that never get evicted.
+static MARK_IGNORE_UNUSED_FUNC void SetTextureResident(TextureID id, Texture2D texture, const TextureSource* source) {
+  TextureResidency* residency = &textureCache.textures[id];
+  if (residency->resident) {
+    textureCache.stats.residentCount--;
+    textureCache.stats.residentBytes -= residency->bytes;
+  }
+  textures[id] = texture;
+  if (source) residency->source = *source;
+  residency->bytes = GetTextureBytes(texture);
+  residency->resident = IsTextureValid(texture);
+  residency->loading = false;
+  residency->wanted = false;
+  residency->failed = !residency->resident;
+  residency->lastUsedFrame = textureCache.frame;
+  if (residency->resident) {
+    textureCache.stats.residentCount++;
+    textureCache.stats.residentBytes += residency->bytes;
+  }
+}
+
+static MARK_IGNORE_UNUSED_FUNC void EvictTexture(TextureID id) {
+  TextureResidency* residency = &textureCache.textures[id];
+  UnloadTexture(textures[id]);
+  textures[id].id = 0; // Size and format stay, for UVs and the reload.
+  residency->resident = false;
+  textureCache.stats.residentCount--;
+  textureCache.stats.residentBytes -= residency->bytes;
+  textureCache.stats.evictions++;
+}
+
+// Evicts least recently drawn candidates until neededBytes more fit in the budget. False if they don't.
+static MARK_IGNORE_UNUSED_FUNC bool MakeTextureRoom(uint64_t neededBytes) {
+  TextureCacheStats* stats = &textureCache.stats;
+  while (stats->residentBytes + neededBytes > stats->budgetBytes) {
+    int      victim = -1;
+    uint64_t oldest = UINT64_MAX;
+    for (int i = 0; i < TEX_COUNT; i++) {
+      TextureResidency* residency = &textureCache.textures[i];
+      if (!residency->resident || !residency->source.fileName || residency->loading) continue;
+      if (residency->lastUsedFrame == textureCache.frame) continue; // On screen.
+      bool idle = textureCache.frame - residency->lastUsedFrame > TEXTURE_IDLE_FRAMES;
+      if (residency->refCount > 0 && !idle) continue;
+      if (residency->lastUsedFrame < oldest) {
+        oldest = residency->lastUsedFrame;
+        victim = i;
+      }
+    }
+    if (victim < 0) return false;
+    EvictTexture((TextureID)victim);
+  }
+  return true;
+}
+
+// Marks a texture as still needed. Evicted textures are queued for a reload.
+static MARK_IGNORE_UNUSED_FUNC void TouchTexture(TextureID id) {
+  TextureResidency* residency = &textureCache.textures[id];
+  residency->lastUsedFrame = textureCache.frame;
+  if (!residency->resident && !residency->loading && !residency->failed && residency->source.fileName) residency->wanted = true;
+}
+
+static MARK_IGNORE_UNUSED_FUNC TextureID AcquireTexture(TextureID id) {
+  textureCache.textures[id].refCount++;
+  TouchTexture(id);
+  return id;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void ReleaseTexture(TextureID id) {
+  if (textureCache.textures[id].refCount > 0) textureCache.textures[id].refCount--;
+}
+
+// What to bind for id this frame: the texture itself, or the placeholder at its size while it's evicted or loading.
+static MARK_IGNORE_UNUSED_FUNC Texture2D GetDrawTexture(TextureID id) {
+  TouchTexture(id);
+  Texture2D texture = textures[id];
+  if (texture.id == 0) texture.id = textures[TEX_NIL].id;
+  return texture;
+}
+
+// Once per frame, after the frame's draws and uploads. Textures drawn this frame stay.
+static MARK_IGNORE_UNUSED_FUNC void EndTextureCacheFrame(void) {
+  textureCache.stats.overBudget = !MakeTextureRoom(0);
+  textureCache.frame++;
+}
+
+#endif // !TEXTURE_CACHE_H
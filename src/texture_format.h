@@ -0,0 +1,112 @@
+#ifndef TEXTURE_FORMAT_H
+#define TEXTURE_FORMAT_H
+
+#include "utils.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ::TEXTURE FORMAT
+// Pre-decoded texture container (.rtex), written by nob's sprite packer next to the atlas PNG so
+// the game can skip PNG inflate and unfiltering at startup:
+//   RawTextureHeader  at offset 0
+//   pixel data        dataSize bytes at dataOffset (RAW_TEXTURE_DATA_ALIGNMENT aligned)
+// The pixels are in raylib's PixelFormat, stored as they are or as one LZ4 block (LZ4's block
+// format, see DecompressRawTexture), whichever is smaller. Mostly empty atlases compress very
+// well and decompress at memory speed. Values are little endian.
+// NOTE: Shared with nob.c, so no raylib in here.
+#define RAW_TEXTURE_MAGIC 0x58455452u // "RTEX"
+#define RAW_TEXTURE_VERSION 1
+#define RAW_TEXTURE_DATA_ALIGNMENT 64
+#define RAW_TEXTURE_FORMAT_R8G8B8A8 7 // PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, what the packer writes.
+#define RAW_TEXTURE_LZ4_MIN_MATCH 4
+
+typedef enum RawTextureCompression {
+  RAW_TEXTURE_UNCOMPRESSED = 0,
+  RAW_TEXTURE_LZ4 = 1,
+} RawTextureCompression;
+
+typedef struct RawTextureHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t format; // raylib PixelFormat.
+  uint32_t mipmaps;
+  uint32_t compression; // RawTextureCompression.
+  uint32_t dataOffset;  // From the start of the file.
+  uint64_t dataSize;    // As stored.
+  uint64_t pixelSize;   // Once decompressed.
+} RawTextureHeader;
+
+// Checks the header and that the data lies inside the file. The caller still has to check
+// pixelSize against the format, that needs raylib's GetPixelDataSize.
+static MARK_IGNORE_UNUSED_FUNC const RawTextureHeader* GetRawTexture(const void* data, size_t size) {
+  if (!data || size < sizeof(RawTextureHeader)) return NULL;
+  const RawTextureHeader* header = (const RawTextureHeader*)data;
+  if (header->magic != RAW_TEXTURE_MAGIC || header->version != RAW_TEXTURE_VERSION) return NULL;
+  if (header->width == 0 || header->height == 0 || header->mipmaps == 0) return NULL;
+  if (header->compression != RAW_TEXTURE_UNCOMPRESSED && header->compression != RAW_TEXTURE_LZ4) return NULL;
+  if (header->compression == RAW_TEXTURE_UNCOMPRESSED && header->dataSize != header->pixelSize) return NULL;
+  if (header->dataOffset < sizeof(RawTextureHeader) || header->dataOffset % RAW_TEXTURE_DATA_ALIGNMENT != 0) return NULL;
+  if (header->dataSize > size || header->dataOffset > size - header->dataSize) return NULL;
+  return header;
+}
+
+static MARK_IGNORE_UNUSED_FUNC const uint8_t* GetRawTextureData(const RawTextureHeader* header) {
+  return (const uint8_t*)header + header->dataOffset;
+}
+
+// Length field continuation of an LZ4 sequence: bytes are added while they're 255.
+static MARK_IGNORE_UNUSED_FUNC bool ReadLZ4Length(const uint8_t** in, const uint8_t* inEnd, size_t* length) {
+  uint8_t byte;
+  do {
+    if (*in >= inEnd) return false;
+    byte = *(*in)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+// Decodes one LZ4 block into exactly outSize bytes. Sequences are a token (literal count in the
+// high nibble, match length - 4 in the low one, 15 meaning more length bytes follow), the
+// literals, then a 2 byte offset back into the output; the last sequence is literals only.
+// Returns false on malformed input instead of reading or writing out of bounds.
+static MARK_IGNORE_UNUSED_FUNC bool DecompressRawTexture(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize) {
+  const uint8_t* inEnd = in + inSize;
+  uint8_t*       op = out;
+  uint8_t*       outEnd = out + outSize;
+  while (in < inEnd) {
+    uint8_t token = *in++;
+    size_t  literals = token >> 4;
+    if (literals == 15 && !ReadLZ4Length(&in, inEnd, &literals)) return false;
+    if (literals > (size_t)(inEnd - in) || literals > (size_t)(outEnd - op)) return false;
+    memcpy(op, in, literals);
+    in += literals;
+    op += literals;
+    if (in == inEnd) break;
+
+    if (inEnd - in < 2) return false;
+    size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+    in += 2;
+    size_t matchLength = token & 15;
+    if (matchLength == 15 && !ReadLZ4Length(&in, inEnd, &matchLength)) return false;
+    matchLength += RAW_TEXTURE_LZ4_MIN_MATCH;
+    if (offset == 0 || offset > (size_t)(op - out) || matchLength > (size_t)(outEnd - op)) return false;
+
+    // Overlapping matches repeat the last offset bytes. Copying what's already been written
+    // doubles the run each step, so a long run of one pixel is a handful of memcpys.
+    const uint8_t* match = op - offset;
+    uint8_t*       matchEnd = op + matchLength;
+    while (op < matchEnd) {
+      size_t chunk = (size_t)(op - match);
+      if (chunk > (size_t)(matchEnd - op)) chunk = (size_t)(matchEnd - op);
+      memcpy(op, match, chunk);
+      op += chunk;
+    }
+  }
+  return op == outEnd;
+}
+
+#endif // !TEXTURE_FORMAT_H
@@ -4,16 +4,15 @@
 #include "include/raylib.h"
 #include "game_defines.h"
 #include "build_defines.h"
+#include "atlas_format.h"
+#include "texture_format.h"
+#include "pack_format.h"
+#include "file_map.h"
+#include "mem_arena.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-typedef struct {
-  const char* filename;
-  Vector2     size;
-  Rectangle   rect;
-} SpriteMetadata;
-
 Vector2 GetImageSize(const char* filePath) {
   Image   img = LoadImage(filePath);
   Vector2 size = (Vector2){(float)img.width, (float)img.height};
@@ -25,46 +24,255 @@ static inline void BuildResourcePath(const char* fileName, char* outPath) {
   snprintf(outPath, MAX_PATH_LENGTH, "%s%cresources%c%s", GetApplicationDirectory(), PATH_SEPARATOR, PATH_SEPARATOR, fileName);
 }
 
-// Load metadata from a file
-int LoadSpriteMeta(const char* fileName, SpriteMetadata* sprites, int maxSprites) {
-  char path[MAX_PATH_LENGTH];
-  BuildResourcePath(fileName, path);
+// ::RESOURCES
+// Files from resources/, found in this order:
+// - Builds with EMBED_RESOURCES (`nob embed`) carry them in the executable and read them from
+//   memory, without any file I/O or path resolution.
+// - The resource pack (RESOURCE_PACK_FILE, pack_format.h) next to the executable, if
+//   MountResourcePack found one. Release builds write it, files are read in place. Release
+//   builds with a pack mounted read nothing else, a file missing from it is an error.
+// - Loose files in bin/resources/ next to the executable, for builds without a pack. Debug
+//   builds check these first and fall back to the pack, see PreferLooseResource.
+#ifndef EMBED_RESOURCES
+#define EMBED_RESOURCES 0
+#endif
 
-  FILE* file = fopen(path, "r");
-  if (!file) {
-    TraceLog(LOG_ERROR, "Failed to open metadata file: %s", path);
-    return 0;
+#if EMBED_RESOURCES
+#include "generated/embedded_resources.h"
+
+typedef struct EmbeddedResource {
+  const char*          fileName;
+  const unsigned char* data;
+  int                  size;
+} EmbeddedResource;
+
+static const EmbeddedResource EMBEDDED_RESOURCE_TABLE[] = {
+#define X(fileName, data) {fileName, data, (int)sizeof(data)},
+    EMBEDDED_RESOURCES(X)
+#undef X
+};
+
+const EmbeddedResource* FindEmbeddedResource(const char* fileName) {
+  for (size_t i = 0; i < sizeof(EMBEDDED_RESOURCE_TABLE) / sizeof(EMBEDDED_RESOURCE_TABLE[0]); i++) {
+    if (strcmp(EMBEDDED_RESOURCE_TABLE[i].fileName, fileName) == 0) return &EMBEDDED_RESOURCE_TABLE[i];
   }
+  return NULL;
+}
+#endif
 
-  int count = 0;
-  fscanf(file, "%d", &count);
-  if (count > maxSprites)
-    count = maxSprites;
+// Mounted once at startup and only read after, so any thread can look files up.
+typedef struct ResourcePack {
+  MappedFile             file;
+  const AssetPackHeader* header; // NULL while no pack is mounted.
+} ResourcePack;
 
-  for (int i = 0; i < count; i++) {
-    static char pathBuffer[512];
-    int         tmp_x, tmp_y, tmp_width, tmp_height;
-    fscanf(file, "%s %d %d %d %d", pathBuffer, &tmp_x, &tmp_y, &tmp_width, &tmp_height);
-    sprites[i].rect = (Rectangle){(float)tmp_x, (float)tmp_y, (float)tmp_width, (float)tmp_height};
+ResourcePack resourcePack = {0};
 
-    sprites[i].filename = strdup(pathBuffer);
-    sprites[i].size = (Vector2){sprites[i].rect.width, sprites[i].rect.height};
+// One open and one mapping for every packed file. Returns false, and resources stay loose
+// files, if there's no pack next to the executable or it doesn't check out.
+bool MountResourcePack() {
+  char path[MAX_PATH_LENGTH];
+  snprintf(path, MAX_PATH_LENGTH, "%s%c%s", GetApplicationDirectory(), PATH_SEPARATOR, RESOURCE_PACK_FILE);
+  if (!FileExists(path)) return false;
+  resourcePack.file = MapFile(path);
+  resourcePack.header = GetAssetPack(resourcePack.file.data, resourcePack.file.size);
+  if (!resourcePack.header) {
+    if (resourcePack.file.data) TraceLog(LOG_ERROR, "Invalid or outdated resource pack, rerun nob pack: %s", path);
+    UnmapFile(&resourcePack.file);
+    return false;
   }
-  fclose(file);
-  return count;
+  TraceLog(LOG_INFO, "RESOURCES: Mounted %s, %u files", RESOURCE_PACK_FILE, resourcePack.header->entryCount);
+  return true;
 }
 
-SpriteMetadata* FindSpriteByFilename(SpriteMetadata* sprites, int count, const char* filename) {
-  for (int i = 0; i < count; i++) {
-    if (strcmp(sprites[i].filename, filename) == 0) {
-      return &sprites[i];
+// After everything read from the pack has been released.
+void UnmountResourcePack() {
+  UnmapFile(&resourcePack.file);
+  resourcePack.header = NULL;
+}
+
+// Stored files are returned in place, LZ4 ones decompressed into MemAlloc'd memory. Release with
+// UnmapFile. False if fileName isn't packed or its data doesn't check out.
+bool LoadPackedResource(const char* fileName, MappedFile* file) {
+  *file = (MappedFile){0};
+  if (!resourcePack.header) return false;
+  const AssetPackEntry* entry = FindAssetPackEntry(resourcePack.header, resourcePack.file.size, fileName);
+  if (!entry) return false;
+  if (entry->compression == ASSET_PACK_UNCOMPRESSED) {
+    *file = (MappedFile){.data = GetAssetPackData(resourcePack.header, entry), .size = (size_t)entry->size, .borrowed = true};
+    return true;
+  }
+  uint8_t* data = (uint8_t*)MemAlloc((unsigned int)entry->size);
+  if (!data || !DecompressAssetPackEntry(resourcePack.header, entry, data)) {
+    TraceLog(LOG_ERROR, "RESOURCES: %s is corrupt in %s", fileName, RESOURCE_PACK_FILE);
+    MemFree(data);
+    return false;
+  }
+  *file = (MappedFile){.data = data, .size = (size_t)entry->size, .heap = true};
+  return true;
+}
+
+// Debug builds take a loose file over the pack: hot reload writes to bin/resources/, and a pack
+// left there by `nob pack` mustn't shadow it. Release builds with a pack mounted read only the pack.
+static inline bool PreferLooseResource(const char* path) {
+#if DEBUG
+  return !resourcePack.header || FileExists(path);
+#else
+  (void)path;
+  return !resourcePack.header;
+#endif
+}
+
+// CPU half of LoadResourceTexture, no GPU calls so any thread can decode. Release with UnloadImage.
+Image LoadResourceImage(const char* fileName) {
+#if EMBED_RESOURCES
+  const EmbeddedResource* resource = FindEmbeddedResource(fileName);
+  if (resource) return LoadImageFromMemory(GetFileExtension(fileName), resource->data, resource->size);
+#endif
+  char path[MAX_PATH_LENGTH];
+  BuildResourcePath(fileName, path);
+  if (PreferLooseResource(path)) return LoadImage(path);
+  MappedFile packed;
+  if (!LoadPackedResource(fileName, &packed)) {
+    TraceLog(LOG_ERROR, "RESOURCES: %s isn't in %s", fileName, RESOURCE_PACK_FILE);
+    return (Image){0};
+  }
+  Image image = LoadImageFromMemory(GetFileExtension(fileName), (const unsigned char*)packed.data, (int)packed.size);
+  UnmapFile(&packed);
+  return image;
+}
+
+Texture2D LoadResourceTexture(const char* fileName) {
+  Image     image = LoadResourceImage(fileName);
+  Texture2D texture = LoadTextureFromImage(image);
+  UnloadImage(image);
+  return texture;
+}
+
+// Release with UnmapFile. Embedded and stored packed resources are returned in place.
+MappedFile LoadResourceFile(const char* fileName) {
+#if EMBED_RESOURCES
+  const EmbeddedResource* resource = FindEmbeddedResource(fileName);
+  if (resource) return (MappedFile){.data = resource->data, .size = (size_t)resource->size, .borrowed = true};
+#endif
+  char path[MAX_PATH_LENGTH];
+  BuildResourcePath(fileName, path);
+  if (PreferLooseResource(path)) return MapFile(path);
+  MappedFile packed;
+  if (!LoadPackedResource(fileName, &packed)) TraceLog(LOG_ERROR, "RESOURCES: %s isn't in %s", fileName, RESOURCE_PACK_FILE);
+  return packed;
+}
+
+// CPU half of LoadResourceRawTexture, any thread. Without staging, uncompressed pixels point into
+// file's mapping, keep it mapped until they're uploaded. With it, pixels are copied out so every
+// read happens here rather than on first touch during the upload. LZ4 pixels are always
+// decompressed: into staging when it has room, else into MemAlloc'd memory, which sets
+// *heapPixels (free with UnloadImage). Returns an image without data if the file is missing or
+// doesn't check out.
+Image LoadResourceRawImage(const char* fileName, MemoryArena* staging, MappedFile* file, bool* heapPixels) {
+  Image image = {0};
+  *heapPixels = false;
+  *file = LoadResourceFile(fileName);
+  const RawTextureHeader* header = GetRawTexture(file->data, file->size);
+  if (header && header->pixelSize == (uint64_t)GetPixelDataSize((int)header->width, (int)header->height, (int)header->format)) {
+    const uint8_t* stored = GetRawTextureData(header);
+    void*          pixels = (void*)stored;
+    if (header->compression == RAW_TEXTURE_LZ4 || staging) {
+      if (staging && AlignUpMaxAlignment(staging->used) + header->pixelSize <= staging->size) {
+        pixels = PushSize(staging, (size_t)header->pixelSize);
+      } else {
+        pixels = MemAlloc((unsigned int)header->pixelSize);
+        *heapPixels = true;
+      }
+      if (header->compression == RAW_TEXTURE_UNCOMPRESSED) {
+        memcpy(pixels, stored, (size_t)header->pixelSize);
+      } else if (!DecompressRawTexture(stored, (size_t)header->dataSize, (uint8_t*)pixels, (size_t)header->pixelSize)) {
+        if (*heapPixels) MemFree(pixels);
+        *heapPixels = false;
+        pixels = NULL;
+      }
     }
+    if (pixels) image = (Image){pixels, (int)header->width, (int)header->height, (int)header->mipmaps, (int)header->format};
   }
-  TraceLog(LOG_WARNING, "Failed to find sprite: %s", filename);
-  return NULL; // Not found
+  if (file->data && !image.data) TraceLog(LOG_WARNING, "Invalid or outdated raw texture, rerun the sprite packer: %s", fileName);
+  if (!image.data || (header && image.data != GetRawTextureData(header))) UnmapFile(file); // Nothing points into it.
+  return image;
+}
+
+// Loads the packer's pre-decoded texture (texture_format.h). Uncompressed pixels go to the GPU
+// straight from the mapping, LZ4 ones after a single decompress pass; no PNG decode either way.
+// Returns an invalid texture if the file is missing or doesn't check out.
+Texture2D LoadResourceRawTexture(const char* fileName) {
+  MappedFile file;
+  bool       heapPixels;
+  Image      image = LoadResourceRawImage(fileName, NULL, &file, &heapPixels);
+  Texture2D  texture = {0};
+  if (image.data) texture = LoadTextureFromImage(image); // Copies to the GPU, image isn't needed after.
+  if (heapPixels) UnloadImage(image);
+  UnmapFile(&file);
+  return texture;
+}
+
+// Maps the packer's binary metadata (atlas_format.h). Rects and names are read in place until
+// UnmapFile, nothing is parsed or allocated.
+const AtlasMetaHeader* LoadAtlasMeta(const char* fileName, MappedFile* file) {
+  *file = LoadResourceFile(fileName);
+  const AtlasMetaHeader* meta = GetAtlasMeta(file->data, file->size);
+  if (file->data && !meta) {
+    TraceLog(LOG_ERROR, "Invalid or outdated atlas metadata, rerun the sprite packer: %s", fileName);
+    UnmapFile(file);
+  }
+  return meta;
+}
+
+const AtlasMetaRect* FindSpriteByName(const AtlasMetaHeader* meta, const char* name) {
+  const AtlasMetaRect* rect = FindAtlasMetaRect(meta, name);
+  if (!rect) TraceLog(LOG_WARNING, "Failed to find sprite: %s", name);
+  return rect;
 }
 
 // ::TEXTURES
+// Atlas sprites are known at compile time (src/generated/), so setting them up is a table copy.
+typedef struct AtlasSprite {
+  SpriteID    id;
+  const char* name;
+  Rectangle   rect;
+} AtlasSprite;
+
+// <ID>_ATLAS_SPRITE_TABLE for each atlas in ATLAS_MANIFEST.
+#define ATLAS_SPRITE_ROW(id, name, x, y, width, height) {id, name, {x, y, width, height}},
+#define X(ID, sourceFolder, fileName, size, maxSprites) \
+  static const AtlasSprite ID##_ATLAS_SPRITE_TABLE[] = {ID##_ATLAS_SPRITES(ATLAS_SPRITE_ROW)};
+ATLAS_MANIFEST(X)
+#undef X
+#undef ATLAS_SPRITE_ROW
+
+// What the game needs to load and watch each atlas, straight from the manifest.
+typedef struct AtlasInfo {
+  TextureID          texture;
+  const char*        sourceFolder;
+  const char*        imageFile;
+  const char*        textureFile;
+  const char*        metaFile;
+  const AtlasSprite* sprites;
+  int                spriteCount;
+  int                size;
+} AtlasInfo;
+
+static const AtlasInfo ATLASES[] = {
+#define X(ID, sourceFolder, fileName, size, maxSprites) \
+  {TEX_##ID, sourceFolder, ATLAS_IMAGE_FILE(fileName), ATLAS_TEXTURE_FILE(fileName), ATLAS_META_FILE(fileName), ID##_ATLAS_SPRITE_TABLE, sizeof(ID##_ATLAS_SPRITE_TABLE) / sizeof(AtlasSprite), size},
+    ATLAS_MANIFEST(X)
+#undef X
+};
+#define ATLAS_COUNT (int)(sizeof(ATLASES) / sizeof(ATLASES[0]))
+
+int GetLargestAtlasSize() {
+  int size = 0;
+  for (int i = 0; i < ATLAS_COUNT; i++) size = ATLASES[i].size > size ? ATLASES[i].size : size;
+  return size;
+}
+
 void setupSprite(SpriteID spriteID, TextureID texID, int startX, int startY, int width, int height) {
   sprites[spriteID] = (SpriteData){
       .sourceTexture = texID,
@@ -72,47 +280,50 @@ void setupSprite(SpriteID spriteID, TextureID texID, int startX, int startY, int
       .size = (Vector2){(float)width, (float)height}
   };
 }
-void setupSpriteFromMetadata(SpriteID spriteID, TextureID texID, SpriteMetadata* metadata) {
+void setupSpriteFromMetadata(SpriteID spriteID, TextureID texID, const AtlasMetaRect* metadata) {
   if (metadata) {
     sprites[spriteID] = (SpriteData){
         .sourceTexture = texID,
-        .sourceRect = metadata->rect,
-        .size = metadata->size};
+        .sourceRect = (Rectangle){metadata->x, metadata->y, metadata->width, metadata->height},
+        .size = (Vector2){metadata->width, metadata->height}};
   } else {
     sprites[spriteID] = sprites[SPRITE_NIL];
   }
 }
-void setupSpriteAsWholeTexture(SpriteID spriteID, TextureID texID) {
-  Texture2D tex = textures[texID];
-  setupSprite(spriteID, texID, 0, 0, tex.width, tex.height);
+void setupSpritesFromAtlas(TextureID texID, const AtlasSprite* table, int count) {
+  for (int i = 0; i < count; i++) {
+    sprites[table[i].id] = (SpriteData){
+        .sourceTexture = texID,
+        .sourceRect = table[i].rect,
+        .size = (Vector2){table[i].rect.width, table[i].rect.height}};
+  }
 }
 
-void LoadAllTexturesAndSprites() {
-  { // Single sprite textures
-    textures[TEX_NIL] = LoadTexture("resources/missing.png");
-    setupSpriteAsWholeTexture(SPRITE_NIL, TEX_NIL);
-    textures[TEX_RAYLIB_LOGO] = LoadTexture("resources/Raylib_logo.png");
-    setupSpriteAsWholeTexture(SPRITE_RAYLIB_LOGO, TEX_RAYLIB_LOGO);
+#if DEBUG
+// The generated table and the packer's metadata come from the same run, unless one of them is stale.
+void CheckAtlasSpritesMatchMeta(const char* metaFileName, const AtlasSprite* table, int count) {
+  MappedFile             metaFile;
+  const AtlasMetaHeader* meta = LoadAtlasMeta(metaFileName, &metaFile);
+  if (!meta) return;
+  if ((int)meta->spriteCount != count) TraceLog(LOG_WARNING, "%s has %u sprites, the generated header %d. Rebuild to regenerate it", metaFileName, meta->spriteCount, count);
+  for (int i = 0; i < count; i++) {
+    const AtlasMetaRect* rect = FindAtlasMetaRect(meta, table[i].name);
+    if (!rect || rect->x != table[i].rect.x || rect->y != table[i].rect.y || rect->width != table[i].rect.width || rect->height != table[i].rect.height)
+      TraceLog(LOG_WARNING, "Sprite %s in the generated header doesn't match %s. Rebuild to regenerate it", table[i].name, metaFileName);
   }
+  UnmapFile(&metaFile);
+}
+#endif
 
-  { // Main Texture
-    SpriteMetadata spritesMetadata[MAIN_ATLAS_MAX_SPRITES] = {0};
-    int            spriteCount = LoadSpriteMeta(MAIN_ATLAS_META_FILE, spritesMetadata, MAIN_ATLAS_MAX_SPRITES);
-    if (spriteCount == 0) {
-      TraceLog(LOG_ERROR, "No valid metadata found!");
-      exit(1);
-    }
-
-    char atlasPath[MAX_PATH_LENGTH];
-    BuildResourcePath(MAIN_ATLAS_IMAGE_FILE, atlasPath);
-    textures[TEX_MAIN] = LoadTexture(atlasPath);
-    setupSpriteFromMetadata(SPRITE_MAIN_PLAYER_1, TEX_MAIN, FindSpriteByFilename(spritesMetadata, spriteCount, "player_1"));
-    setupSpriteFromMetadata(SPRITE_MAIN_PLAYER_2, TEX_MAIN, FindSpriteByFilename(spritesMetadata, spriteCount, "player_2"));
-  }
+void setupSpriteAsWholeTexture(SpriteID spriteID, TextureID texID) {
+  Texture2D tex = textures[texID];
+  setupSprite(spriteID, texID, 0, 0, tex.width, tex.height);
 }
 
 void UnloadAllTextures() {
   for (int iTex = 0; iTex < TEX_COUNT; iTex++) {
+    if (iTex == TEX_FONT_DEFAULT) continue; // CloseWindow unloads it.
+    if (!IsTextureValid(textures[iTex])) continue; // Never finished loading.
     UnloadTexture(textures[iTex]);
   }
 }
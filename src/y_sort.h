@@ -0,0 +1,143 @@
+#ifndef Y_SORT_H
+#define Y_SORT_H
+
+#include "mem_arena.h"
+#include "utils.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// ::Y SORT
+// Draw order by Y for top-down layers, kept across frames instead of sorted from scratch.
+// Y is quantized to whole pixels and packed above the item index into one 64 bit key, so
+// ties go by index and both paths give the same order. Items are indices into the caller's
+// arrays, which have to stay in the same order between frames for the incremental path to help:
+// - Same count as last frame: last frame's order is re-keyed and insertion sorted, which is
+//   close to linear when most things stand still or move slowly. Gives up after
+//   YSORT_MAX_SHIFTS_PER_ITEM moves per item on average, past that the radix sort is cheaper
+//   (e.g. dense crowds where every pixel row holds hundreds of sprites).
+// - Otherwise, or after giving up: LSD radix sort on the Y bits, rebased to the frame's
+//   minimum so bytes every key shares are skipped.
+#define YSORT_STEPS_PER_PIXEL 1.0f
+#define YSORT_MAX_SHIFTS_PER_ITEM 2
+#define YSORT_RADIX_BITS 11 // One pass covers a 2048 pixel tall range.
+#define YSORT_RADIX_MASK ((1 << YSORT_RADIX_BITS) - 1)
+#define YSORT_RADIX_PASSES 3
+#define YSORT_RADIX_COOLDOWN 30 // Frames to skip the incremental path after it gave up.
+
+typedef struct YSortIndex {
+  uint32_t  capacity;
+  uint32_t  count;
+  uint32_t* order; // Item indices, lowest Y first.
+  uint64_t* keys;  // Y above index, in sorted order.
+  uint64_t* keysScratch;
+  uint32_t  histograms[YSORT_RADIX_PASSES][1 << YSORT_RADIX_BITS]; // Radix sort counts, per index so indexes can sort in parallel.
+  uint32_t  radixFramesLeft;
+  bool      lastWasIncremental;
+} YSortIndex;
+
+static MARK_IGNORE_UNUSED_FUNC size_t YSortIndexArenaSize(uint32_t capacity) {
+  return AlignUpMaxAlignment(sizeof(YSortIndex)) +
+         AlignUpMaxAlignment(sizeof(uint32_t) * capacity) +
+         AlignUpMaxAlignment(sizeof(uint64_t) * capacity) * 2;
+}
+
+static MARK_IGNORE_UNUSED_FUNC YSortIndex* CreateYSortIndex(MemoryArena* arena, uint32_t capacity) {
+  YSortIndex* index = PushType(arena, YSortIndex);
+  memset(index, 0, sizeof(YSortIndex));
+  index->capacity = capacity;
+  index->order = PushArray(arena, capacity, uint32_t);
+  index->keys = PushArray(arena, capacity, uint64_t);
+  index->keysScratch = PushArray(arena, capacity, uint64_t);
+  return index;
+}
+
+// Order preserving, clamped so far off values (and NaN) can't overflow the int conversion.
+static MARK_IGNORE_UNUSED_FUNC uint32_t QuantizeSortY(float y) {
+  const float LIMIT = 1e9f;
+  float       scaled = y * YSORT_STEPS_PER_PIXEL;
+  if (!(scaled > -LIMIT)) scaled = -LIMIT;
+  if (scaled > LIMIT) scaled = LIMIT;
+  return (uint32_t)(int32_t)scaled ^ 0x80000000u;
+}
+
+// Returns false if it ran out of moves, keys are still a permutation then.
+static MARK_IGNORE_UNUSED_FUNC bool InsertionSortYKeys(uint64_t* keys, uint32_t count, uint64_t maxShifts) {
+  uint64_t shifts = 0;
+  for (uint32_t k = 1; k < count; k++) {
+    uint64_t key = keys[k];
+    uint32_t j = k;
+    while (j > 0 && keys[j - 1] > key) {
+      keys[j] = keys[j - 1];
+      j--;
+    }
+    keys[j] = key;
+    shifts += k - j;
+    if (shifts > maxShifts) return false;
+  }
+  return true;
+}
+
+static MARK_IGNORE_UNUSED_FUNC void RadixSortYKeys(YSortIndex* index, const float* y, uint32_t count) {
+  uint32_t  minY = UINT32_MAX, maxY = 0;
+  uint32_t* quantized = index->order; // Reused as scratch, rewritten from the keys after.
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t q = QuantizeSortY(y[i]);
+    quantized[i] = q;
+    if (q < minY) minY = q;
+    if (q > maxY) maxY = q;
+  }
+
+  // Rebased to the minimum, so only as many digits as the Y range needs get a pass.
+  uint32_t range = count ? maxY - minY : 0;
+  int      passCount = 0;
+  while (passCount < YSORT_RADIX_PASSES && (range >> (passCount * YSORT_RADIX_BITS)) != 0) passCount++;
+  memset(index->histograms, 0, sizeof(index->histograms[0]) * passCount);
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t rebased = quantized[i] - minY;
+    index->keys[i] = ((uint64_t)rebased << 32) | i;
+    for (int pass = 0; pass < passCount; pass++) index->histograms[pass][(rebased >> (pass * YSORT_RADIX_BITS)) & YSORT_RADIX_MASK]++;
+  }
+
+  uint64_t* src = index->keys;
+  uint64_t* dst = index->keysScratch;
+  for (int pass = 0; pass < passCount; pass++) {
+    int       shift = 32 + pass * YSORT_RADIX_BITS;
+    uint32_t* histogram = index->histograms[pass];
+    uint32_t  offset = 0;
+    for (int b = 0; b <= YSORT_RADIX_MASK; b++) {
+      uint32_t bucketSize = histogram[b];
+      histogram[b] = offset;
+      offset += bucketSize;
+    }
+    for (uint32_t i = 0; i < count; i++) dst[histogram[(src[i] >> shift) & YSORT_RADIX_MASK]++] = src[i];
+    uint64_t* swap = src;
+    src = dst;
+    dst = swap;
+  }
+  if (src != index->keys) memcpy(index->keys, src, sizeof(uint64_t) * count);
+}
+
+// Sorts items 0..count-1 by y[i] and returns the order, valid until the next update.
+static MARK_IGNORE_UNUSED_FUNC const uint32_t* UpdateYSortIndex(YSortIndex* index, const float* y, uint32_t count) {
+  if (count > index->capacity) count = index->capacity;
+
+  index->lastWasIncremental = false;
+  if (count == index->count && index->radixFramesLeft == 0) {
+    for (uint32_t k = 0; k < count; k++) {
+      uint32_t item = index->order[k];
+      index->keys[k] = ((uint64_t)QuantizeSortY(y[item]) << 32) | item;
+    }
+    index->lastWasIncremental = InsertionSortYKeys(index->keys, count, (uint64_t)count * YSORT_MAX_SHIFTS_PER_ITEM);
+    if (!index->lastWasIncremental) index->radixFramesLeft = YSORT_RADIX_COOLDOWN;
+  } else if (index->radixFramesLeft > 0) {
+    index->radixFramesLeft--;
+  }
+
+  if (!index->lastWasIncremental) RadixSortYKeys(index, y, count);
+  for (uint32_t k = 0; k < count; k++) index->order[k] = (uint32_t)index->keys[k];
+  index->count = count;
+  return index->order;
+}
+
+#endif // !Y_SORT_H